@@ -0,0 +1,115 @@
+/*
+
+Additive-increase multiplicative-decrease limiter.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+// $Revision: 12038 $ $Date:: 2019-09-25 #$ $Author: serge $
+
+#ifndef LIB_DIALER_AIMD_LIMITER_H
+#define LIB_DIALER_AIMD_LIMITER_H
+
+#include <cstdint>                  // uint32_t
+#include <chrono>                   // std::chrono::steady_clock
+
+#include "namespace_lib.h"          // NAMESPACE_DIALER_START
+
+NAMESPACE_DIALER_START
+
+// Number of calls allowed at once, between 0 and a maximum: grows by a step per success
+// and is multiplied by a factor below 1 per failure. Failures within hold_ms of a decrease
+// are one event and do not decrease it again. A limit below 1 allows no calls, so no successes
+// can raise it; it is set to 1 after hold_ms without failures to probe again.
+// Not thread-safe, the owner locks.
+class AimdLimiter
+{
+public:
+    typedef std::chrono::steady_clock::time_point   time_point;
+
+    struct Config
+    {
+        double      increase;       // per success
+        double      decrease;       // factor per failure, 0..1
+        uint32_t    hold_ms;
+    };
+
+public:
+    AimdLimiter():
+        AimdLimiter( Config { 1.0, 0.5, 1000 }, 1.0 )
+    {
+    }
+
+    AimdLimiter( const Config & config, double max_limit ):
+        config_( config ),
+        max_limit_( max_limit ),
+        limit_( max_limit )
+    {
+    }
+
+    void set_max_limit( double max_limit )
+    {
+        max_limit_  = max_limit;
+
+        if( limit_ > max_limit_ )
+            limit_  = max_limit_;
+    }
+
+    void on_success()
+    {
+        limit_ += config_.increase;
+
+        if( limit_ > max_limit_ )
+            limit_  = max_limit_;
+    }
+
+    // true if the limit was decreased
+    bool on_failure( const time_point & now )
+    {
+        if( decrease_time_ != time_point() && now - decrease_time_ < std::chrono::milliseconds( config_.hold_ms ) )
+            return false;
+
+        limit_          *= config_.decrease;
+        decrease_time_  = now;
+
+        return true;
+    }
+
+    uint32_t get_limit( const time_point & now )
+    {
+        if( limit_ < 1.0 && now - decrease_time_ >= std::chrono::milliseconds( config_.hold_ms ) )
+            limit_  = ( max_limit_ < 1.0 ) ? max_limit_ : 1.0;
+
+        return static_cast<uint32_t>( limit_ );
+    }
+
+    double get_value() const
+    {
+        return limit_;
+    }
+
+private:
+    Config      config_;
+    double      max_limit_;
+    double      limit_;
+    time_point  decrease_time_;     // of the last decrease
+};
+
+NAMESPACE_DIALER_END
+
+#endif // LIB_DIALER_AIMD_LIMITER_H
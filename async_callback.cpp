@@ -0,0 +1,239 @@
+/*
+
+Asynchronous callback delivery.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+// $Revision: 12038 $ $Date:: 2019-09-25 #$ $Author: serge $
+
+#include "async_callback.h"         // self
+
+#include <algorithm>                // std::min
+#include <typeinfo>                 // typeid
+
+#include "../simple_voip/objects.h"  // Dialing, Ringing, DtmfTone, CallDuration
+#include "../utils/dummy_logger.h"  // dummy_log
+#include "../utils/mutex_helper.h"  // MUTEX_SCOPE_LOCK
+#include "../utils/utils_assert.h"  // ASSERT
+
+#define MODULENAME      "AsyncCallback"
+
+#define INITIAL_CAPACITY    64      // power of 2
+
+NAMESPACE_DIALER_START
+
+AsyncCallback::AsyncCallback():
+    consumer_( nullptr ),
+    batch_consumer_( nullptr ),
+    max_batch_size_( 1 ),
+    ring_( INITIAL_CAPACITY, nullptr ),
+    head_( 0 ),
+    size_( 0 ),
+    max_size_( 0 ),
+    size_limit_( 0 ),
+    num_dropped_( 0 ),
+    must_stop_( false )
+{
+}
+
+AsyncCallback::~AsyncCallback()
+{
+    shutdown();
+}
+
+bool AsyncCallback::init( simple_voip::ISimpleVoipCallback * consumer, uint32_t max_batch_size, uint32_t max_size )
+{
+    if( consumer == nullptr || max_batch_size == 0 )
+        return false;
+
+    MUTEX_SCOPE_LOCK( mutex_ );
+
+    consumer_       = consumer;
+    batch_consumer_ = dynamic_cast<IBatchCallback*>( consumer );
+    max_batch_size_ = max_batch_size;
+    size_limit_     = max_size;
+
+    dummy_log_info( MODULENAME, "init: max batch size %u, max size %u, batch interface %s", max_batch_size, max_size, batch_consumer_ ? "yes" : "no" );
+
+    return true;
+}
+
+void AsyncCallback::start()
+{
+    ASSERT( consumer_ );
+
+    thread_ = std::thread( & AsyncCallback::delivery_thread, this );
+}
+
+void AsyncCallback::shutdown()
+{
+    {
+        MUTEX_SCOPE_LOCK( mutex_ );
+
+        must_stop_  = true;
+    }
+
+    cond_.notify_one();
+
+    if( thread_.joinable() )
+        thread_.join();
+}
+
+void AsyncCallback::consume( const simple_voip::CallbackObject * obj )
+{
+    bool was_empty;
+
+    {
+        MUTEX_SCOPE_LOCK( mutex_ );
+
+        was_empty   = ( size_ == 0 );
+
+        // nobody would deliver it after shutdown
+        if( must_stop_ || push__( obj ) == false )
+        {
+            ++num_dropped_;
+
+            // not logged for every object, the consumer is slow already
+            if( ( num_dropped_ & ( num_dropped_ - 1 ) ) == 0 )
+                dummy_log_warn( MODULENAME, "consume: %s, %u object(s) dropped so far", must_stop_ ? "shut down" : "buffer is full", num_dropped_ );
+
+            // the consumer owns the objects, so they are dropped the way it would release them
+            delete obj;
+
+            return;
+        }
+    }
+
+    // the delivery thread only sleeps when the buffer is empty
+    if( was_empty )
+        cond_.notify_one();
+}
+
+uint32_t AsyncCallback::get_max_size() const
+{
+    MUTEX_SCOPE_LOCK( mutex_ );
+
+    return max_size_;
+}
+
+uint32_t AsyncCallback::get_num_dropped() const
+{
+    MUTEX_SCOPE_LOCK( mutex_ );
+
+    return num_dropped_;
+}
+
+bool AsyncCallback::push__( const simple_voip::CallbackObject * obj )
+{
+    uint32_t capacity = ring_.size();
+
+    // responses and the end of a call must reach the client, the buffer grows for them
+    if( size_limit_ != 0 && size_ >= size_limit_ && is_informational( obj ) )
+        return false;
+
+    if( size_ == capacity )
+    {
+        // unroll into a buffer of double size
+        std::vector<const simple_voip::CallbackObject*> ring( capacity * 2, nullptr );
+
+        for( uint32_t i = 0; i < size_; ++i )
+            ring[ i ] = ring_[ ( head_ + i ) & ( capacity - 1 ) ];
+
+        ring_.swap( ring );
+
+        head_       = 0;
+        capacity    *= 2;
+
+        dummy_log_debug( MODULENAME, "push: grown to %u", capacity );
+    }
+
+    ring_[ ( head_ + size_ ) & ( capacity - 1 ) ] = obj;
+
+    ++size_;
+
+    if( size_ > max_size_ )
+        max_size_ = size_;
+
+    return true;
+}
+
+bool AsyncCallback::is_informational( const simple_voip::CallbackObject * obj )
+{
+    return typeid( *obj ) == typeid( simple_voip::Dialing ) ||
+            typeid( *obj ) == typeid( simple_voip::Ringing ) ||
+            typeid( *obj ) == typeid( simple_voip::DtmfTone ) ||
+            typeid( *obj ) == typeid( simple_voip::CallDuration );
+}
+
+uint32_t AsyncCallback::pop__( const simple_voip::CallbackObject ** objs, uint32_t max_size )
+{
+    uint32_t capacity   = ring_.size();
+    uint32_t n          = std::min( size_, max_size );
+
+    for( uint32_t i = 0; i < n; ++i )
+    {
+        objs[ i ]   = ring_[ head_ ];
+        head_       = ( head_ + 1 ) & ( capacity - 1 );
+    }
+
+    size_   -= n;
+
+    return n;
+}
+
+void AsyncCallback::delivery_thread()
+{
+    dummy_log_debug( MODULENAME, "delivery_thread: started" );
+
+    std::vector<const simple_voip::CallbackObject*> batch( max_batch_size_ );
+
+    while( true )
+    {
+        uint32_t n;
+
+        {
+            std::unique_lock<std::mutex> lock( mutex_ );
+
+            cond_.wait( lock, [this]() { return size_ > 0 || must_stop_; } );
+
+            // on stop the remaining objects are delivered first
+            if( size_ == 0 )
+                break;
+
+            n = pop__( batch.data(), max_batch_size_ );
+        }
+
+        deliver( batch.data(), n );
+    }
+
+    dummy_log_debug( MODULENAME, "delivery_thread: exit" );
+}
+
+void AsyncCallback::deliver( const simple_voip::CallbackObject ** objs, uint32_t size )
+{
+    if( batch_consumer_ )
+    {
+        batch_consumer_->consume_batch( objs, size );
+        return;
+    }
+
+    for( uint32_t i = 0; i < size; ++i )
+        consumer_->consume( objs[ i ] );
+}
+
+NAMESPACE_DIALER_END
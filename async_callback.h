@@ -0,0 +1,98 @@
+/*
+
+Asynchronous callback delivery.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+// $Revision: 12038 $ $Date:: 2019-09-25 #$ $Author: serge $
+
+#ifndef LIB_DIALER_ASYNC_CALLBACK_H
+#define LIB_DIALER_ASYNC_CALLBACK_H
+
+#include <cstdint>                  // uint32_t
+#include <vector>                   // std::vector
+#include <mutex>                    // std::mutex
+#include <condition_variable>       // std::condition_variable
+#include <thread>                   // std::thread
+
+#include "../simple_voip/i_simple_voip_callback.h" // ISimpleVoipCallback
+
+#include "i_batch_callback.h"       // IBatchCallback
+
+#include "namespace_lib.h"          // NAMESPACE_DIALER_START
+
+NAMESPACE_DIALER_START
+
+// Decouples the producer from a slow consumer: consume() only appends to
+// a ring buffer, a delivery thread hands the objects over to the consumer.
+// Objects queued together are delivered as one batch if the consumer
+// implements IBatchCallback. Beyond max_size only informational objects (Dialing,
+// Ringing, DtmfTone, CallDuration) are dropped, so a stuck consumer cannot exhaust memory
+// with them; responses and call state changes are never dropped, the buffer grows for them.
+// Objects passed in after shutdown() are dropped, nobody would deliver them.
+class AsyncCallback: virtual public simple_voip::ISimpleVoipCallback
+{
+public:
+    AsyncCallback();
+    ~AsyncCallback();
+
+    // max_size - max number of queued objects before informational ones are dropped, 0 - unlimited
+    bool init( simple_voip::ISimpleVoipCallback * consumer, uint32_t max_batch_size, uint32_t max_size = 0 );
+
+    void start();
+
+    // delivers the remaining objects and stops the delivery thread
+    void shutdown();
+
+    // interface ISimpleVoipCallback, can be called from any thread
+    virtual void consume( const simple_voip::CallbackObject * obj );
+
+    uint32_t get_max_size() const;
+    uint32_t get_num_dropped() const;
+
+private:
+    void delivery_thread();
+
+    bool push__( const simple_voip::CallbackObject * obj );
+    static bool is_informational( const simple_voip::CallbackObject * obj );
+    uint32_t pop__( const simple_voip::CallbackObject ** objs, uint32_t max_size );
+
+    void deliver( const simple_voip::CallbackObject ** objs, uint32_t size );
+
+private:
+    mutable std::mutex                  mutex_;     // protects the ring buffer only, never held while delivering
+    std::condition_variable             cond_;
+
+    simple_voip::ISimpleVoipCallback    * consumer_;
+    IBatchCallback                      * batch_consumer_;  // nullptr if not supported by the consumer
+    uint32_t                            max_batch_size_;
+
+    std::vector<const simple_voip::CallbackObject*> ring_;  // capacity is a power of 2
+    uint32_t                            head_;
+    uint32_t                            size_;
+    uint32_t                            max_size_;          // high-water mark
+    uint32_t                            size_limit_;        // 0 - unlimited
+    uint32_t                            num_dropped_;
+
+    bool                                must_stop_;
+    std::thread                         thread_;
+};
+
+NAMESPACE_DIALER_END
+
+#endif // LIB_DIALER_ASYNC_CALLBACK_H
@@ -0,0 +1,75 @@
+/*
+
+Call outcome.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+// $Revision: 12038 $ $Date:: 2019-09-25 #$ $Author: serge $
+
+#ifndef LIB_DIALER_CALL_OUTCOME_H
+#define LIB_DIALER_CALL_OUTCOME_H
+
+#include <cstdint>                  // uint32_t
+
+#include "failure_reason.h"         // failure_reason_e
+
+#include "namespace_lib.h"          // NAMESPACE_DIALER_START
+
+NAMESPACE_DIALER_START
+
+enum class call_result_e : uint8_t
+{
+    REJECTED        = 0,    // request not processed
+    SETUP_ERROR,            // call could not be initiated
+    FAILED,
+    BUSY,
+    REFUSED,
+    NO_ANSWER,
+    CANCELED,               // dropped by the client before connection
+    COMPLETED,              // connected, then ended by either side
+    CONNECTION_LOST,        // connected, then ended by an error
+    BLOCKED,                // not dialed: on the do-not-call list or without a route
+    VOICEMAIL,              // connected to voicemail, dropped by the dialer
+};
+
+// Summary of an InitiateCallRequest, sent exactly once per request
+// after the call has ended or the request was refused.
+struct CallOutcome
+{
+    uint32_t            req_id;         // of the InitiateCallRequest
+    uint32_t            call_id;        // 0 if the call was not initiated
+    call_result_e       result;
+    failure_reason_e    failure_reason;
+    uint32_t            pstn_status;    // 0 - none
+    uint32_t            post_dial_ms;   // request to ringing, or to the end if there was no ringing
+    uint32_t            ring_ms;        // ringing to connection or end
+    uint32_t            talk_ms;        // connection to end, 0 if not connected
+};
+
+class IOutcomeCallback
+{
+public:
+    virtual ~IOutcomeCallback() {}
+
+    // called by the worker thread, must not block
+    virtual void on_call_outcome( const CallOutcome & outcome ) = 0;
+};
+
+NAMESPACE_DIALER_END
+
+#endif // LIB_DIALER_CALL_OUTCOME_H
@@ -0,0 +1,151 @@
+/*
+
+Callback dispatcher.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+// $Revision: 12038 $ $Date:: 2019-09-25 #$ $Author: serge $
+
+#include "callback_dispatcher.h"    // self
+
+#include "../utils/dummy_logger.h"  // dummy_log
+#include "../utils/mutex_helper.h"  // MUTEX_SCOPE_LOCK
+
+#include "async_callback.h"         // AsyncCallback
+
+#define MODULENAME      "CallbackDispatcher"
+
+NAMESPACE_DIALER_START
+
+CallbackDispatcher::CallbackDispatcher():
+    pool_( nullptr ),
+    subscribers_( std::make_shared<const SubscriberList>() ),
+    version_( 0 ),
+    wanted_mask_( 0 ),
+    cached_( subscribers_ ),
+    cached_version_( 0 )
+{
+}
+
+void CallbackDispatcher::init( CallbackObjectPool * pool )
+{
+    pool_   = pool;
+}
+
+bool CallbackDispatcher::add_subscriber( const Subscriber & subscriber )
+{
+    MUTEX_SCOPE_LOCK( mutex_ );
+
+    auto old = std::atomic_load( & subscribers_ );
+
+    for( const auto & s : * old )
+    {
+        if( s.key == subscriber.key )
+            return false;
+    }
+
+    auto subscribers = std::make_shared<SubscriberList>( * old );
+
+    subscribers->push_back( subscriber );
+
+    publish__( subscribers );
+
+    dummy_log_info( MODULENAME, "add_subscriber: mask %x, %u subscriber(s)", subscriber.mask, subscribers->size() );
+
+    return true;
+}
+
+bool CallbackDispatcher::remove_subscriber( const void * key )
+{
+    AsyncCallback           * async = nullptr;
+    std::shared_ptr<void>   holder;         // keeps async valid, the worker may have dropped the old list already
+
+    {
+        MUTEX_SCOPE_LOCK( mutex_ );
+
+        auto old = std::atomic_load( & subscribers_ );
+
+        auto subscribers = std::make_shared<SubscriberList>();
+
+        for( const auto & s : * old )
+        {
+            if( s.key != key )
+                subscribers->push_back( s );
+            else
+            {
+                async   = s.async;
+                holder  = s.holder;
+            }
+        }
+
+        if( subscribers->size() == old->size() )
+            return false;
+
+        // the worker may still send objects already being dispatched
+        publish__( subscribers );
+
+        dummy_log_info( MODULENAME, "remove_subscriber: %u subscriber(s)", subscribers->size() );
+    }
+
+    // objects the worker still sends are dropped after this point,
+    // so destroying the holder on the worker thread has nothing to join
+    if( async )
+        async->shutdown();
+
+    return true;
+}
+
+void CallbackDispatcher::clear()
+{
+    MUTEX_SCOPE_LOCK( mutex_ );
+
+    publish__( std::make_shared<const SubscriberList>() );
+
+    cached_         = std::atomic_load( & subscribers_ );
+    cached_version_ = version_.load();
+}
+
+void CallbackDispatcher::publish__( const SubscriberListPtr & subscribers )
+{
+    uint32_t mask = 0;
+
+    for( const auto & s : * subscribers )
+        mask |= s.mask;
+
+    std::atomic_store( & subscribers_, subscribers );
+
+    wanted_mask_.store( mask, std::memory_order_relaxed );
+
+    version_.fetch_add( 1, std::memory_order_release );
+}
+
+const CallbackDispatcher::SubscriberList & CallbackDispatcher::get_subscribers()
+{
+    // the shared pointer is only reloaded after a change
+    uint32_t version = version_.load( std::memory_order_acquire );
+
+    if( version != cached_version_ )
+    {
+        cached_         = std::atomic_load( & subscribers_ );
+        cached_version_ = version;
+    }
+
+    return * cached_;
+}
+
+NAMESPACE_DIALER_END
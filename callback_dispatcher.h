@@ -0,0 +1,210 @@
+/*
+
+Callback dispatcher.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+// $Revision: 12038 $ $Date:: 2019-09-25 #$ $Author: serge $
+
+#ifndef LIB_DIALER_CALLBACK_DISPATCHER_H
+#define LIB_DIALER_CALLBACK_DISPATCHER_H
+
+#include <cstdint>                  // uint32_t
+#include <vector>                   // std::vector
+#include <memory>                   // std::shared_ptr
+#include <mutex>                    // std::mutex
+#include <atomic>                   // std::atomic
+#include <type_traits>              // std::remove_pointer
+
+#include "../simple_voip/i_simple_voip_callback.h" // ISimpleVoipCallback
+
+#include "i_typed_callback.h"       // ITypedCallback
+#include "callback_object_pool.h"   // CallbackObjectPool
+
+#include "namespace_lib.h"          // NAMESPACE_DIALER_START
+
+// builds the object only if at least one subscriber wants it
+#define CALLBACK_SEND( _dispatcher, _create )   ( _dispatcher ).send( [&]() { return _create; } )
+
+NAMESPACE_DIALER_START
+
+class AsyncCallback;
+
+// kinds of callback objects a subscriber is interested in
+enum callback_mask_e : uint32_t
+{
+    CALLBACK_INITIATE_CALL_RESPONSE     = 1 << 0,
+    CALLBACK_ERROR_RESPONSE             = 1 << 1,
+    CALLBACK_REJECT_RESPONSE            = 1 << 2,
+    CALLBACK_DROP_RESPONSE              = 1 << 3,
+    CALLBACK_PLAY_FILE_RESPONSE         = 1 << 4,
+    CALLBACK_PLAY_FILE_STOP_RESPONSE    = 1 << 5,
+    CALLBACK_RECORD_FILE_RESPONSE       = 1 << 6,
+    CALLBACK_DIALING                    = 1 << 7,
+    CALLBACK_RINGING                    = 1 << 8,
+    CALLBACK_CONNECTED                  = 1 << 9,
+    CALLBACK_FAILED                     = 1 << 10,
+    CALLBACK_CONNECTION_LOST            = 1 << 11,
+    CALLBACK_DTMF_TONE                  = 1 << 12,
+    CALLBACK_CALL_DURATION              = 1 << 13,
+
+    CALLBACK_RESPONSES                  = ( 1 << 7 ) - 1,
+    CALLBACK_CALL_EVENTS                = CALLBACK_DIALING | CALLBACK_RINGING | CALLBACK_CONNECTED | CALLBACK_FAILED | CALLBACK_CONNECTION_LOST,
+    CALLBACK_ALL                        = ( 1 << 14 ) - 1,
+};
+
+// Sends the objects produced by Dialer and PlayerSM to the subscribers.
+// The type of the object is known at the call site, so a typed subscriber is
+// called directly, a generic one gets an own copy of the object and owns it.
+// Subscribers can be changed from any thread, the list is copied on write;
+// objects are sent by the worker thread only.
+class CallbackDispatcher
+{
+public:
+    struct Subscriber
+    {
+        const void                          * key;              // the client's callback
+        simple_voip::ISimpleVoipCallback    * callback;         // either callback ...
+        ITypedCallback                      * typed_callback;   // ... or typed_callback is set
+        uint32_t                            mask;               // callback_mask_e
+        AsyncCallback                       * async;            // delivery thread of the subscriber, nullptr - none
+        std::shared_ptr<void>               holder;             // keeps the delivery wrappers of the subscriber alive
+    };
+
+public:
+    CallbackDispatcher();
+
+    void init( CallbackObjectPool * pool );
+
+    // false if the key is already subscribed
+    bool add_subscriber( const Subscriber & subscriber );
+
+    // the delivery thread of the subscriber is stopped by the calling thread,
+    // so the worker never waits for client code when it drops the old list
+    bool remove_subscriber( const void * key );
+
+    // drops all subscribers, must not be called while objects are sent
+    void clear();
+
+    template<class _T>
+    bool is_wanted() const
+    {
+        return ( wanted_mask_.load( std::memory_order_relaxed ) & get_kind( static_cast<const _T*>( nullptr ) ) ) != 0;
+    }
+
+    // create - functor returning a new object, it is only called if the object is wanted
+    template<class _F>
+    void send( const _F & create )
+    {
+        typedef typename std::remove_pointer<decltype( create() )>::type Type;
+
+        if( is_wanted<Type>() )
+            consume( create() );
+    }
+
+    template<class _T>
+    void consume( _T * obj )
+    {
+        const auto & subscribers    = get_subscribers();
+        uint32_t kind               = get_kind( obj );
+        uint32_t num_generic        = 0;
+
+        // typed subscribers first, the object must stay valid for them
+        for( const auto & s : subscribers )
+        {
+            if( ( s.mask & kind ) == 0 )
+                continue;
+
+            if( s.typed_callback )
+                deliver( s.typed_callback, * obj );
+            else
+                ++num_generic;
+        }
+
+        for( const auto & s : subscribers )
+        {
+            if( ( s.mask & kind ) == 0 || s.callback == nullptr )
+                continue;
+
+            if( --num_generic == 0 )
+            {
+                // the last one gets the original object
+                s.callback->consume( obj );
+                return;
+            }
+
+            s.callback->consume( pool_->clone_t( obj ) );
+        }
+
+        pool_->release_t( obj );
+    }
+
+    static uint32_t get_kind( const simple_voip::InitiateCallResponse * )   { return CALLBACK_INITIATE_CALL_RESPONSE; }
+    static uint32_t get_kind( const simple_voip::ErrorResponse * )          { return CALLBACK_ERROR_RESPONSE; }
+    static uint32_t get_kind( const simple_voip::RejectResponse * )         { return CALLBACK_REJECT_RESPONSE; }
+    static uint32_t get_kind( const simple_voip::DropResponse * )           { return CALLBACK_DROP_RESPONSE; }
+    static uint32_t get_kind( const simple_voip::PlayFileResponse * )       { return CALLBACK_PLAY_FILE_RESPONSE; }
+    static uint32_t get_kind( const simple_voip::PlayFileStopResponse * )   { return CALLBACK_PLAY_FILE_STOP_RESPONSE; }
+    static uint32_t get_kind( const simple_voip::RecordFileResponse * )     { return CALLBACK_RECORD_FILE_RESPONSE; }
+    static uint32_t get_kind( const simple_voip::Dialing * )                { return CALLBACK_DIALING; }
+    static uint32_t get_kind( const simple_voip::Ringing * )                { return CALLBACK_RINGING; }
+    static uint32_t get_kind( const simple_voip::Connected * )              { return CALLBACK_CONNECTED; }
+    static uint32_t get_kind( const simple_voip::Failed * )                 { return CALLBACK_FAILED; }
+    static uint32_t get_kind( const simple_voip::ConnectionLost * )         { return CALLBACK_CONNECTION_LOST; }
+    static uint32_t get_kind( const simple_voip::DtmfTone * )               { return CALLBACK_DTMF_TONE; }
+    static uint32_t get_kind( const simple_voip::CallDuration * )           { return CALLBACK_CALL_DURATION; }
+
+    static void deliver( ITypedCallback * c, const simple_voip::InitiateCallResponse & obj )    { c->on_initiate_call_response( obj ); }
+    static void deliver( ITypedCallback * c, const simple_voip::ErrorResponse & obj )           { c->on_error_response( obj ); }
+    static void deliver( ITypedCallback * c, const simple_voip::RejectResponse & obj )          { c->on_reject_response( obj ); }
+    static void deliver( ITypedCallback * c, const simple_voip::DropResponse & obj )            { c->on_drop_response( obj ); }
+    static void deliver( ITypedCallback * c, const simple_voip::PlayFileResponse & obj )        { c->on_play_file_response( obj ); }
+    static void deliver( ITypedCallback * c, const simple_voip::PlayFileStopResponse & obj )    { c->on_play_file_stop_response( obj ); }
+    static void deliver( ITypedCallback * c, const simple_voip::RecordFileResponse & obj )      { c->on_record_file_response( obj ); }
+    static void deliver( ITypedCallback * c, const simple_voip::Dialing & obj )                 { c->on_dialing( obj ); }
+    static void deliver( ITypedCallback * c, const simple_voip::Ringing & obj )                 { c->on_ringing( obj ); }
+    static void deliver( ITypedCallback * c, const simple_voip::Connected & obj )               { c->on_connected( obj ); }
+    static void deliver( ITypedCallback * c, const simple_voip::Failed & obj )                  { c->on_failed( obj ); }
+    static void deliver( ITypedCallback * c, const simple_voip::ConnectionLost & obj )          { c->on_connection_lost( obj ); }
+    static void deliver( ITypedCallback * c, const simple_voip::DtmfTone & obj )                { c->on_dtmf_tone( obj ); }
+    static void deliver( ITypedCallback * c, const simple_voip::CallDuration & obj )            { c->on_call_duration( obj ); }
+
+private:
+    typedef std::vector<Subscriber>             SubscriberList;
+    typedef std::shared_ptr<const SubscriberList>   SubscriberListPtr;
+
+    const SubscriberList & get_subscribers();
+
+    void publish__( const SubscriberListPtr & subscribers );
+
+private:
+    CallbackObjectPool                  * pool_;
+
+    std::mutex                          mutex_;         // serializes writers
+    SubscriberListPtr                   subscribers_;   // accessed with std::atomic_load/store
+    std::atomic<uint32_t>               version_;
+    std::atomic<uint32_t>               wanted_mask_;   // union of the subscribers' masks
+
+    // worker thread only
+    SubscriberListPtr                   cached_;
+    uint32_t                            cached_version_;
+};
+
+NAMESPACE_DIALER_END
+
+#endif // LIB_DIALER_CALLBACK_DISPATCHER_H
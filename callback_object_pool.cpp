@@ -0,0 +1,246 @@
+/*
+
+Pool of callback objects.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+// $Revision: 12038 $ $Date:: 2019-09-25 #$ $Author: serge $
+
+#include "callback_object_pool.h"   // self
+
+#include <typeinfo>                 // typeid
+
+#include "../utils/dummy_logger.h"  // dummy_log
+#include "../utils/mutex_helper.h"  // MUTEX_SCOPE_LOCK
+
+#define MODULENAME      "CallbackObjectPool"
+
+NAMESPACE_DIALER_START
+
+CallbackObjectPool::CallbackObjectPool():
+    max_free_objects_( 0 ),
+    num_allocated_( 0 )
+{
+}
+
+CallbackObjectPool::~CallbackObjectPool()
+{
+}
+
+void CallbackObjectPool::init( uint32_t max_free_objects )
+{
+    MUTEX_SCOPE_LOCK( mutex_ );
+
+    max_free_objects_   = max_free_objects;
+
+    // free lists never reallocate in steady state
+    initiate_call_responses_.reserve( max_free_objects );
+    error_responses_.reserve( max_free_objects );
+    reject_responses_.reserve( max_free_objects );
+    drop_responses_.reserve( max_free_objects );
+    play_file_responses_.reserve( max_free_objects );
+    play_file_stop_responses_.reserve( max_free_objects );
+    record_file_responses_.reserve( max_free_objects );
+    dialings_.reserve( max_free_objects );
+    ringings_.reserve( max_free_objects );
+    connecteds_.reserve( max_free_objects );
+    faileds_.reserve( max_free_objects );
+    connection_losts_.reserve( max_free_objects );
+    dtmf_tones_.reserve( max_free_objects );
+    call_durations_.reserve( max_free_objects );
+
+    dummy_log_info( MODULENAME, "init: max free objects per type %u", max_free_objects );
+}
+
+void CallbackObjectPool::prefill()
+{
+    MUTEX_SCOPE_LOCK( mutex_ );
+
+    initiate_call_responses_.fill( max_free_objects_, & num_allocated_ );
+    error_responses_.fill( max_free_objects_, & num_allocated_ );
+    reject_responses_.fill( max_free_objects_, & num_allocated_ );
+    drop_responses_.fill( max_free_objects_, & num_allocated_ );
+    play_file_responses_.fill( max_free_objects_, & num_allocated_ );
+    play_file_stop_responses_.fill( max_free_objects_, & num_allocated_ );
+    record_file_responses_.fill( max_free_objects_, & num_allocated_ );
+    dialings_.fill( max_free_objects_, & num_allocated_ );
+    ringings_.fill( max_free_objects_, & num_allocated_ );
+    connecteds_.fill( max_free_objects_, & num_allocated_ );
+    faileds_.fill( max_free_objects_, & num_allocated_ );
+    connection_losts_.fill( max_free_objects_, & num_allocated_ );
+    dtmf_tones_.fill( max_free_objects_, & num_allocated_ );
+    call_durations_.fill( max_free_objects_, & num_allocated_ );
+
+    dummy_log_debug( MODULENAME, "prefill: %u object(s) allocated", num_allocated_ );
+}
+
+template<class _T>
+bool CallbackObjectPool::try_release_t( const simple_voip::CallbackObject * obj )
+{
+    if( typeid( *obj ) != typeid( _T ) )
+        return false;
+
+    release_t( static_cast<const _T*>( obj ) );
+
+    return true;
+}
+
+void CallbackObjectPool::release( const simple_voip::CallbackObject * obj )
+{
+    if( obj == nullptr )
+        return;
+
+    if( try_release_t<simple_voip::InitiateCallResponse>( obj )
+        || try_release_t<simple_voip::ErrorResponse>( obj )
+        || try_release_t<simple_voip::RejectResponse>( obj )
+        || try_release_t<simple_voip::DropResponse>( obj )
+        || try_release_t<simple_voip::PlayFileResponse>( obj )
+        || try_release_t<simple_voip::PlayFileStopResponse>( obj )
+        || try_release_t<simple_voip::RecordFileResponse>( obj )
+        || try_release_t<simple_voip::Dialing>( obj )
+        || try_release_t<simple_voip::Ringing>( obj )
+        || try_release_t<simple_voip::Connected>( obj )
+        || try_release_t<simple_voip::Failed>( obj )
+        || try_release_t<simple_voip::ConnectionLost>( obj )
+        || try_release_t<simple_voip::DtmfTone>( obj )
+        || try_release_t<simple_voip::CallDuration>( obj ) )
+    {
+        return;
+    }
+
+    // not created by the pool
+    delete obj;
+}
+
+simple_voip::InitiateCallResponse * CallbackObjectPool::create_initiate_call_response( uint32_t req_id, uint32_t call_id )
+{
+    auto res = get_t<simple_voip::InitiateCallResponse>();
+
+    res->req_id     = req_id;
+    res->call_id    = call_id;
+
+    return res;
+}
+
+simple_voip::ErrorResponse * CallbackObjectPool::create_error_response( uint32_t req_id, uint32_t errorcode, const std::string & descr )
+{
+    auto res = get_t<simple_voip::ErrorResponse>();
+
+    res->req_id     = req_id;
+    res->errorcode  = errorcode;
+    res->descr      = descr;
+
+    return res;
+}
+
+simple_voip::RejectResponse * CallbackObjectPool::create_reject_response( uint32_t req_id, uint32_t errorcode, const std::string & descr )
+{
+    auto res = get_t<simple_voip::RejectResponse>();
+
+    res->req_id     = req_id;
+    res->errorcode  = errorcode;
+    res->descr      = descr;
+
+    return res;
+}
+
+simple_voip::DropResponse * CallbackObjectPool::create_drop_response( uint32_t req_id )
+{
+    auto res = get_t<simple_voip::DropResponse>();
+
+    res->req_id     = req_id;
+
+    return res;
+}
+
+simple_voip::PlayFileResponse * CallbackObjectPool::create_play_file_response( uint32_t req_id )
+{
+    auto res = get_t<simple_voip::PlayFileResponse>();
+
+    res->req_id     = req_id;
+
+    return res;
+}
+
+simple_voip::PlayFileStopResponse * CallbackObjectPool::create_play_file_stop_response( uint32_t req_id )
+{
+    auto res = get_t<simple_voip::PlayFileStopResponse>();
+
+    res->req_id     = req_id;
+
+    return res;
+}
+
+simple_voip::RecordFileResponse * CallbackObjectPool::create_record_file_response( uint32_t req_id )
+{
+    auto res = get_t<simple_voip::RecordFileResponse>();
+
+    res->req_id     = req_id;
+
+    return res;
+}
+
+simple_voip::Failed * CallbackObjectPool::create_failed( uint32_t call_id, simple_voip::Failed::type_e type, const std::string & descr )
+{
+    auto res = get_t<simple_voip::Failed>();
+
+    res->call_id    = call_id;
+    res->type       = type;
+    res->descr      = descr;
+
+    return res;
+}
+
+simple_voip::ConnectionLost * CallbackObjectPool::create_connection_lost( uint32_t call_id, const std::string & descr )
+{
+    auto res = get_t<simple_voip::ConnectionLost>();
+
+    res->call_id    = call_id;
+    res->descr      = descr;
+
+    return res;
+}
+
+simple_voip::DtmfTone * CallbackObjectPool::create_dtmf_tone( uint32_t call_id, simple_voip::DtmfTone::tone_e tone )
+{
+    auto res = get_t<simple_voip::DtmfTone>();
+
+    res->call_id    = call_id;
+    res->tone       = tone;
+
+    return res;
+}
+
+simple_voip::CallDuration * CallbackObjectPool::create_call_duration( uint32_t call_id, uint32_t t )
+{
+    auto res = get_t<simple_voip::CallDuration>();
+
+    res->call_id    = call_id;
+    res->t          = t;
+
+    return res;
+}
+
+uint32_t CallbackObjectPool::get_num_allocated() const
+{
+    MUTEX_SCOPE_LOCK( mutex_ );
+
+    return num_allocated_;
+}
+
+NAMESPACE_DIALER_END
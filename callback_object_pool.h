@@ -0,0 +1,212 @@
+/*
+
+Pool of callback objects.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+// $Revision: 12038 $ $Date:: 2019-09-25 #$ $Author: serge $
+
+#ifndef LIB_DIALER_CALLBACK_OBJECT_POOL_H
+#define LIB_DIALER_CALLBACK_OBJECT_POOL_H
+
+#include <cstdint>                  // uint32_t
+#include <string>                   // std::string
+#include <vector>                   // std::vector
+#include <mutex>                    // std::mutex
+
+#include "../simple_voip/objects.h" // simple_voip::CallbackObject
+#include "../utils/mutex_helper.h"  // MUTEX_SCOPE_LOCK
+
+#include "namespace_lib.h"          // NAMESPACE_DIALER_START
+
+NAMESPACE_DIALER_START
+
+// Recycles the callback objects sent by the dialer, mirrors simple_voip::create_*.
+// Objects are plain heap objects: a client may still delete them,
+// released ones are reused, so the steady state needs no allocations.
+// With max_free_objects == 0 nothing is kept, which is the behavior of the simple_voip factories.
+class CallbackObjectPool
+{
+public:
+    CallbackObjectPool();
+    ~CallbackObjectPool();
+
+    // max_free_objects - max number of released objects kept per type
+    void init( uint32_t max_free_objects );
+
+    // allocates the free objects in advance, so the first calls need no allocations
+    void prefill();
+
+    // can be called from any thread
+    void release( const simple_voip::CallbackObject * obj );
+
+    // same as release(), if the exact type of the object is known
+    template<class _T>
+    void release_t( const _T * obj )
+    {
+        // the object is owned by the caller, const only protects it from the consumer
+        _T * o = const_cast<_T*>( obj );
+
+        MUTEX_SCOPE_LOCK( mutex_ );
+
+        get_list( o ).put( o, max_free_objects_ );
+    }
+
+    // creation, called by the worker thread
+    simple_voip::InitiateCallResponse * create_initiate_call_response( uint32_t req_id, uint32_t call_id );
+    simple_voip::ErrorResponse * create_error_response( uint32_t req_id, uint32_t errorcode, const std::string & descr );
+    simple_voip::RejectResponse * create_reject_response( uint32_t req_id, uint32_t errorcode, const std::string & descr );
+    simple_voip::DropResponse * create_drop_response( uint32_t req_id );
+    simple_voip::PlayFileResponse * create_play_file_response( uint32_t req_id );
+    simple_voip::PlayFileStopResponse * create_play_file_stop_response( uint32_t req_id );
+    simple_voip::RecordFileResponse * create_record_file_response( uint32_t req_id );
+    simple_voip::Failed * create_failed( uint32_t call_id, simple_voip::Failed::type_e type, const std::string & descr );
+    simple_voip::ConnectionLost * create_connection_lost( uint32_t call_id, const std::string & descr );
+    simple_voip::DtmfTone * create_dtmf_tone( uint32_t call_id, simple_voip::DtmfTone::tone_e tone );
+    simple_voip::CallDuration * create_call_duration( uint32_t call_id, uint32_t t );
+
+    template<class _T>
+    _T * create_message_t( uint32_t call_id )
+    {
+        _T * res = get_t<_T>();
+
+        res->call_id    = call_id;
+
+        return res;
+    }
+
+    // copy for another consumer
+    template<class _T>
+    _T * clone_t( const _T * obj )
+    {
+        _T * res = get_t<_T>();
+
+        * res = * obj;
+
+        return res;
+    }
+
+    uint32_t get_num_allocated() const;
+
+private:
+    template <class _T>
+    class FreeListT
+    {
+    public:
+        ~FreeListT()
+        {
+            for( auto o : free_ )
+                delete o;
+        }
+
+        _T * get( uint32_t * num_allocated )
+        {
+            if( free_.empty() )
+            {
+                ++*num_allocated;
+                return new _T;
+            }
+
+            _T * res = free_.back();
+
+            free_.pop_back();
+
+            return res;
+        }
+
+        void put( _T * obj, uint32_t max_size )
+        {
+            if( free_.size() >= max_size )
+            {
+                delete obj;
+                return;
+            }
+
+            free_.push_back( obj );
+        }
+
+        void reserve( uint32_t max_size )
+        {
+            free_.reserve( max_size );
+        }
+
+        void fill( uint32_t max_size, uint32_t * num_allocated )
+        {
+            while( free_.size() < max_size )
+            {
+                ++*num_allocated;
+                free_.push_back( new _T );
+            }
+        }
+
+    private:
+        std::vector<_T*>    free_;
+    };
+
+private:
+    template<class _T>
+    _T * get_t()
+    {
+        MUTEX_SCOPE_LOCK( mutex_ );
+
+        return get_list( static_cast<_T*>( nullptr ) ).get( & num_allocated_ );
+    }
+
+    template<class _T>
+    bool try_release_t( const simple_voip::CallbackObject * obj );
+
+    FreeListT<simple_voip::InitiateCallResponse>    & get_list( simple_voip::InitiateCallResponse * )   { return initiate_call_responses_; }
+    FreeListT<simple_voip::ErrorResponse>           & get_list( simple_voip::ErrorResponse * )          { return error_responses_; }
+    FreeListT<simple_voip::RejectResponse>          & get_list( simple_voip::RejectResponse * )         { return reject_responses_; }
+    FreeListT<simple_voip::DropResponse>            & get_list( simple_voip::DropResponse * )           { return drop_responses_; }
+    FreeListT<simple_voip::PlayFileResponse>        & get_list( simple_voip::PlayFileResponse * )       { return play_file_responses_; }
+    FreeListT<simple_voip::PlayFileStopResponse>    & get_list( simple_voip::PlayFileStopResponse * )   { return play_file_stop_responses_; }
+    FreeListT<simple_voip::RecordFileResponse>      & get_list( simple_voip::RecordFileResponse * )     { return record_file_responses_; }
+    FreeListT<simple_voip::Dialing>                 & get_list( simple_voip::Dialing * )                { return dialings_; }
+    FreeListT<simple_voip::Ringing>                 & get_list( simple_voip::Ringing * )                { return ringings_; }
+    FreeListT<simple_voip::Connected>               & get_list( simple_voip::Connected * )              { return connecteds_; }
+    FreeListT<simple_voip::Failed>                  & get_list( simple_voip::Failed * )                 { return faileds_; }
+    FreeListT<simple_voip::ConnectionLost>          & get_list( simple_voip::ConnectionLost * )         { return connection_losts_; }
+    FreeListT<simple_voip::DtmfTone>                & get_list( simple_voip::DtmfTone * )               { return dtmf_tones_; }
+    FreeListT<simple_voip::CallDuration>            & get_list( simple_voip::CallDuration * )           { return call_durations_; }
+
+private:
+    mutable std::mutex                              mutex_;
+
+    uint32_t                                        max_free_objects_;
+    uint32_t                                        num_allocated_;
+
+    FreeListT<simple_voip::InitiateCallResponse>    initiate_call_responses_;
+    FreeListT<simple_voip::ErrorResponse>           error_responses_;
+    FreeListT<simple_voip::RejectResponse>          reject_responses_;
+    FreeListT<simple_voip::DropResponse>            drop_responses_;
+    FreeListT<simple_voip::PlayFileResponse>        play_file_responses_;
+    FreeListT<simple_voip::PlayFileStopResponse>    play_file_stop_responses_;
+    FreeListT<simple_voip::RecordFileResponse>      record_file_responses_;
+    FreeListT<simple_voip::Dialing>                 dialings_;
+    FreeListT<simple_voip::Ringing>                 ringings_;
+    FreeListT<simple_voip::Connected>               connecteds_;
+    FreeListT<simple_voip::Failed>                  faileds_;
+    FreeListT<simple_voip::ConnectionLost>          connection_losts_;
+    FreeListT<simple_voip::DtmfTone>                dtmf_tones_;
+    FreeListT<simple_voip::CallDuration>            call_durations_;
+};
+
+NAMESPACE_DIALER_END
+
+#endif // LIB_DIALER_CALLBACK_OBJECT_POOL_H
@@ -0,0 +1,430 @@
+/*
+
+Campaign.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+// $Revision: 12038 $ $Date:: 2019-09-25 #$ $Author: serge $
+
+#include "campaign.h"               // self
+
+#include "../simple_voip/object_factory.h"  // create_initiate_call_request
+#include "../utils/dummy_logger.h"          // dummy_log
+#include "../utils/mutex_helper.h"          // MUTEX_SCOPE_LOCK
+
+#include "str_helper.h"             // StrHelper
+#include "redial_scheduler.h"       // RedialScheduler
+
+#define MODULENAME      "Campaign"
+
+NAMESPACE_DIALER_START
+
+Campaign::Campaign():
+    voip_( nullptr ),
+    redial_( nullptr ),
+    source_( nullptr ),
+    is_source_exhausted_( true ),
+    first_req_id_( 0 ),
+    num_req_ids_( 0 ),
+    last_req_id_( 0 ),
+    concurrency_( 0 ),
+    is_started_( false ),
+    is_filling_( false ),
+    must_refill_( false ),
+    retry_ms_( 1000 ),
+    is_retry_due_( false ),
+    must_stop_( false ),
+    num_issued_( 0 ),
+    num_in_flight_( 0 ),
+    num_queued_( 0 )
+{
+    for( auto & n : num_results_ )
+        n.store( 0, std::memory_order_relaxed );
+}
+
+Campaign::~Campaign()
+{
+    {
+        MUTEX_SCOPE_LOCK( mutex_ );
+
+        must_stop_  = true;
+    }
+
+    retry_cond_.notify_one();
+
+    if( retry_thread_.joinable() )
+        retry_thread_.join();
+}
+
+bool Campaign::init(
+        simple_voip::ISimpleVoip    * voip,
+        uint32_t                    first_req_id,
+        uint32_t                    num_req_ids,
+        uint32_t                    concurrency )
+{
+    MUTEX_SCOPE_LOCK( mutex_ );
+
+    if( voip == nullptr || first_req_id == 0 || concurrency == 0 )
+        return false;
+
+    // ids must not be reused while still in flight
+    if( num_req_ids < concurrency || first_req_id + ( num_req_ids - 1 ) < first_req_id )
+        return false;
+
+    voip_           = voip;
+    first_req_id_   = first_req_id;
+    num_req_ids_    = num_req_ids;
+    last_req_id_    = num_req_ids - 1;
+    concurrency_    = concurrency;
+
+    dummy_log_info( MODULENAME, "init: req ids %u-%u, concurrency %u", first_req_id, first_req_id + ( num_req_ids - 1 ), concurrency );
+
+    return true;
+}
+
+void Campaign::set_redial_scheduler( RedialScheduler * redial )
+{
+    MUTEX_SCOPE_LOCK( mutex_ );
+
+    redial_     = redial;
+}
+
+void Campaign::set_retry_delay( uint32_t retry_ms )
+{
+    MUTEX_SCOPE_LOCK( mutex_ );
+
+    retry_ms_   = retry_ms;
+}
+
+void Campaign::set_party_source( IPartySource * source )
+{
+    MUTEX_SCOPE_LOCK( mutex_ );
+
+    source_                 = source;
+    is_source_exhausted_    = ( source == nullptr );
+}
+
+void Campaign::add_parties( const std::vector<std::string> & parties )
+{
+    {
+        MUTEX_SCOPE_LOCK( mutex_ );
+
+        for( const auto & p : parties )
+            parties_.push_back( Party { parties_table_.add( p ), 1 } );
+
+        num_queued_ = parties_.size();
+
+        dummy_log_debug( MODULENAME, "add_parties: %u added, %u queued", (unsigned) parties.size(), (unsigned) parties_.size() );
+    }
+
+    fill();
+}
+
+void Campaign::add_redials( const std::vector<std::pair<std::string,uint32_t>> & parties )
+{
+    {
+        MUTEX_SCOPE_LOCK( mutex_ );
+
+        for( auto it = parties.rbegin(); it != parties.rend(); ++it )
+            parties_.push_front( Party { parties_table_.add( it->first ), it->second } );
+
+        num_queued_ = parties_.size();
+    }
+
+    fill();
+}
+
+void Campaign::start()
+{
+    {
+        MUTEX_SCOPE_LOCK( mutex_ );
+
+        is_started_ = true;
+
+        if( retry_ms_ > 0 && retry_thread_.joinable() == false )
+            retry_thread_   = std::thread( & Campaign::retry_thread, this );
+    }
+
+    dummy_log_info( MODULENAME, "start: %u queued", num_queued_.load() );
+
+    fill();
+}
+
+void Campaign::stop()
+{
+    MUTEX_SCOPE_LOCK( mutex_ );
+
+    // calls in flight are not dropped
+    is_started_ = false;
+
+    dummy_log_info( MODULENAME, "stop: %u in flight, %u queued", (unsigned) in_flight_.size(), (unsigned) parties_.size() );
+}
+
+void Campaign::resume()
+{
+    fill();
+}
+
+void Campaign::set_concurrency( uint32_t concurrency )
+{
+    if( concurrency == 0 )
+        return;
+
+    {
+        MUTEX_SCOPE_LOCK( mutex_ );
+
+        // ids must not be reused while still in flight
+        if( concurrency > num_req_ids_ )
+        {
+            dummy_log_debug( MODULENAME, "set_concurrency: %u clamped to the number of req ids %u", concurrency, num_req_ids_ );
+
+            concurrency = num_req_ids_;
+        }
+
+        concurrency_    = concurrency;
+    }
+
+    fill();
+}
+
+void Campaign::on_call_outcome( const CallOutcome & outcome )
+{
+    // called by the worker thread of the dialer
+
+    if( is_own_req_id( outcome.req_id ) == false )
+        return;
+
+    bool must_fill = false;
+
+    {
+        MUTEX_SCOPE_LOCK( mutex_ );
+
+        auto it = in_flight_.find( outcome.req_id );
+
+        if( it == in_flight_.end() )
+        {
+            dummy_log_error( MODULENAME, "req id %u: unexpected outcome %s", outcome.req_id, StrHelper::to_string( outcome.result ).c_str() );
+            return;
+        }
+
+        if( outcome.result == call_result_e::REJECTED )
+        {
+            // will be dialed again later
+            parties_.push_front( it->second );
+        }
+        else
+        {
+            must_fill   = true;
+        }
+
+        if( outcome.result != call_result_e::REJECTED )
+        {
+            // scheduled before the party leaves in_flight_, so the campaign never looks finished in between
+            if( redial_ )
+                redial_->schedule( parties_table_.get( it->second.party ), it->second.attempt, outcome );
+
+            parties_table_.release( it->second.party );
+        }
+
+        in_flight_.erase( it );
+
+        num_in_flight_  = in_flight_.size();
+        num_queued_     = parties_.size();
+
+        // no further outcome would refill the lines
+        if( outcome.result == call_result_e::REJECTED && in_flight_.empty() && is_retry_due_ == false )
+        {
+            is_retry_due_   = true;
+
+            retry_cond_.notify_one();
+        }
+    }
+
+    num_results_[ static_cast<int>( outcome.result ) ].fetch_add( 1, std::memory_order_relaxed );
+
+    dummy_log_debug( MODULENAME, "req id %u: %s", outcome.req_id, StrHelper::to_string( outcome.result ).c_str() );
+
+    if( must_fill )
+        fill();
+}
+
+uint32_t Campaign::get_num_issued() const
+{
+    return num_issued_.load( std::memory_order_relaxed );
+}
+
+uint32_t Campaign::get_num_results( call_result_e result ) const
+{
+    return num_results_[ static_cast<int>( result ) ].load( std::memory_order_relaxed );
+}
+
+uint32_t Campaign::get_num_in_flight() const
+{
+    return num_in_flight_.load( std::memory_order_relaxed );
+}
+
+uint32_t Campaign::get_num_queued() const
+{
+    return num_queued_.load( std::memory_order_relaxed );
+}
+
+bool Campaign::is_finished() const
+{
+    MUTEX_SCOPE_LOCK( mutex_ );
+
+    return parties_.empty() && is_source_exhausted_ && in_flight_.empty() && ( redial_ == nullptr || redial_->get_num_pending() == 0 );
+}
+
+void Campaign::fill()
+{
+    std::unique_lock<std::mutex> lock( mutex_ );
+
+    // only one thread sends, the others leave a note for it
+    if( is_filling_ )
+    {
+        must_refill_    = true;
+        return;
+    }
+
+    is_filling_     = true;
+
+    do
+    {
+        must_refill_    = false;
+
+        std::vector<Request> requests;
+
+        pull_parties__();
+
+        while( is_started_ && in_flight_.size() < concurrency_ && parties_.empty() == false )
+        {
+            const auto & p = parties_.front();
+
+            Request r = { next_req_id__(), parties_table_.get( p.party ), p.attempt };
+
+            in_flight_[ r.req_id ] = p;
+
+            parties_.pop_front();
+
+            requests.push_back( r );
+        }
+
+        num_in_flight_  = in_flight_.size();
+        num_queued_     = parties_.size();
+
+        if( requests.empty() )
+            break;
+
+        lock.unlock();
+
+        // outcome of a rejected request may be delivered synchronously
+        for( const auto & r : requests )
+        {
+            dummy_log_debug( MODULENAME, "req id %u: dialing %s, attempt %u", r.req_id, r.party.c_str(), r.attempt );
+
+            num_issued_.fetch_add( 1, std::memory_order_relaxed );
+
+            voip_->consume( simple_voip::create_initiate_call_request( r.req_id, r.party ) );
+        }
+
+        lock.lock();
+    }
+    while( must_refill_ );
+
+    is_filling_     = false;
+}
+
+void Campaign::retry_thread()
+{
+    dummy_log_debug( MODULENAME, "retry_thread: started" );
+
+    std::unique_lock<std::mutex> lock( mutex_ );
+
+    while( must_stop_ == false )
+    {
+        retry_cond_.wait( lock, [this]() { return is_retry_due_ || must_stop_; } );
+
+        // the delay is not shortened by further rejects
+        retry_cond_.wait_for( lock, std::chrono::milliseconds( retry_ms_ ), [this]() { return must_stop_; } );
+
+        if( must_stop_ )
+            break;
+
+        is_retry_due_   = false;
+
+        dummy_log_debug( MODULENAME, "retry: %u queued", (unsigned) parties_.size() );
+
+        lock.unlock();
+
+        fill();
+
+        lock.lock();
+    }
+
+    dummy_log_debug( MODULENAME, "retry_thread: exit" );
+}
+
+void Campaign::pull_parties__()
+{
+    // private: no mutex lock
+
+    // a few lines worth of parties, the rest stays in the source
+    static const uint32_t PULL_SIZE = 1024;
+
+    std::vector<std::string> parties;
+
+    while( is_source_exhausted_ == false && parties_.size() < concurrency_ )
+    {
+        parties.clear();
+
+        if( source_->get_parties( & parties, PULL_SIZE ) == false )
+        {
+            dummy_log_info( MODULENAME, "party source exhausted" );
+
+            is_source_exhausted_    = true;
+            return;
+        }
+
+        // nothing ready yet, the source resumes the campaign later
+        if( parties.empty() )
+            return;
+
+        for( const auto & p : parties )
+            parties_.push_back( Party { parties_table_.add( p ), 1 } );
+    }
+}
+
+bool Campaign::is_own_req_id( uint32_t req_id ) const
+{
+    return req_id - first_req_id_ < num_req_ids_;
+}
+
+uint32_t Campaign::next_req_id__()
+{
+    // private: no mutex lock
+
+    do
+    {
+        last_req_id_    = ( last_req_id_ + 1 ) % num_req_ids_;
+    }
+    while( in_flight_.count( first_req_id_ + last_req_id_ ) > 0 );
+
+    return first_req_id_ + last_req_id_;
+}
+
+NAMESPACE_DIALER_END
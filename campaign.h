@@ -0,0 +1,168 @@
+/*
+
+Campaign.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+// $Revision: 12038 $ $Date:: 2019-09-25 #$ $Author: serge $
+
+#ifndef LIB_DIALER_CAMPAIGN_H
+#define LIB_DIALER_CAMPAIGN_H
+
+#include <cstdint>                  // uint32_t
+#include <string>                   // std::string
+#include <vector>                   // std::vector
+#include <deque>                    // std::deque
+#include <map>                      // std::map
+#include <mutex>                    // std::mutex
+#include <condition_variable>       // std::condition_variable
+#include <thread>                   // std::thread
+#include <atomic>                   // std::atomic
+
+#include "../simple_voip/i_simple_voip.h"   // ISimpleVoip
+
+#include "call_outcome.h"           // IOutcomeCallback
+#include "i_party_source.h"         // IPartySource
+#include "party_table.h"            // PartyTable
+
+#include "namespace_lib.h"          // NAMESPACE_DIALER_START
+
+NAMESPACE_DIALER_START
+
+class RedialScheduler;
+
+// Dials a list of parties keeping up to 'concurrency' calls in flight.
+// The next call is issued from the outcome of the previous one, i.e. by the worker
+// thread as soon as the line is free. The campaign must be registered as outcome
+// callback of the dialer (Dialer or MultiDialer) it sends the requests to.
+// A REJECTED request (e.g. no account available, route busy or rate-limited) puts its party
+// back into the queue, but does not issue a new call at once, so the dialer is not flooded:
+// the lines are refilled by the next outcome or, if no call is left in flight, after the retry delay.
+// With a redial scheduler other outcomes may be dialed again later, according to its policies.
+class Campaign:
+        virtual public IOutcomeCallback
+{
+public:
+    Campaign();
+    ~Campaign();
+
+    // req ids [first_req_id, first_req_id + num_req_ids) are used exclusively by the campaign,
+    // num_req_ids limits the concurrency; with a PacingController it should be at least
+    // capacity * max_ratio of the controller
+    bool init(
+            simple_voip::ISimpleVoip    * voip,
+            uint32_t                    first_req_id,
+            uint32_t                    num_req_ids,
+            uint32_t                    concurrency );
+
+    // must be called before start()
+    void set_redial_scheduler( RedialScheduler * redial );
+
+    // delay of the refill after rejects with no call in flight, must be called before start();
+    // 0 - no automatic refill, resume() must be called
+    void set_retry_delay( uint32_t retry_ms );
+
+    // parties are pulled from the source when the queue runs low, must be called before start()
+    void set_party_source( IPartySource * source );
+
+    // can be called at any time
+    void add_parties( const std::vector<std::string> & parties );
+
+    // called by the redial scheduler, due redials are dialed before the new parties;
+    // second - number of the attempt
+    void add_redials( const std::vector<std::pair<std::string,uint32_t>> & parties );
+
+    void start();
+    void stop();
+
+    // issues calls up to the concurrency, after rejects
+    void resume();
+
+    // clamped to num_req_ids of init(), 0 is ignored
+    void set_concurrency( uint32_t concurrency );
+
+    // interface IOutcomeCallback
+    virtual void on_call_outcome( const CallOutcome & outcome );
+
+    // lock-free, can be called from any thread
+    uint32_t get_num_issued() const;
+    uint32_t get_num_results( call_result_e result ) const;
+    uint32_t get_num_in_flight() const;
+    uint32_t get_num_queued() const;
+
+    // all parties dialed, source exhausted, no call in flight and no redial pending
+    bool is_finished() const;
+
+private:
+    // 16 bytes, numbers need no further memory
+    struct Party
+    {
+        uint64_t        party;      // key in parties_table_
+        uint32_t        attempt;    // 1 - first call
+    };
+
+    struct Request
+    {
+        uint32_t        req_id;
+        std::string     party;
+        uint32_t        attempt;
+    };
+
+private:
+    void fill();
+    void retry_thread();
+    void pull_parties__();
+    bool is_own_req_id( uint32_t req_id ) const;
+    uint32_t next_req_id__();
+
+private:
+    mutable std::mutex                  mutex_;
+
+    simple_voip::ISimpleVoip            * voip_;
+    RedialScheduler                     * redial_;
+    IPartySource                        * source_;
+    bool                                is_source_exhausted_;
+
+    uint32_t                            first_req_id_;
+    uint32_t                            num_req_ids_;
+    uint32_t                            last_req_id_;   // offset of the last issued id
+
+    std::atomic<uint32_t>               concurrency_;
+    bool                                is_started_;
+    bool                                is_filling_;    // a thread is sending requests
+    bool                                must_refill_;   // set by other threads while is_filling_
+
+    PartyTable                          parties_table_;
+    std::deque<Party>                   parties_;
+    std::map<uint32_t,Party>            in_flight_;     // req_id -> party
+
+    uint32_t                            retry_ms_;
+    bool                                is_retry_due_;  // rejected with no call in flight
+    bool                                must_stop_;
+    std::condition_variable             retry_cond_;
+    std::thread                         retry_thread_;
+
+    std::atomic<uint32_t>               num_issued_;
+    std::atomic<uint32_t>               num_in_flight_;
+    std::atomic<uint32_t>               num_queued_;
+    std::atomic<uint32_t>               num_results_[ static_cast<int>( call_result_e::VOICEMAIL ) + 1 ];
+};
+
+NAMESPACE_DIALER_END
+
+#endif // LIB_DIALER_CAMPAIGN_H
@@ -0,0 +1,83 @@
+/*
+
+Dialer config.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+// $Revision: 12038 $ $Date:: 2019-09-25 #$ $Author: serge $
+
+#ifndef LIB_DIALER_CONFIG_H
+#define LIB_DIALER_CONFIG_H
+
+#include <cstdint>                  // uint32_t
+#include <string>                   // std::string
+
+#include "namespace_lib.h"          // NAMESPACE_DIALER_START
+
+NAMESPACE_DIALER_START
+
+// what to do when a connected call is answered by voicemail
+enum class voicemail_policy_e
+{
+    NONE,               // left to the client
+    DROP,               // hang up at once
+    PLAY_AND_DROP       // play Config::voicemail_prompt, then hang up
+};
+
+struct Config
+{
+    Config():
+        data_port( 0 ),
+        request_timeout_ms( 0 ),
+        max_pending_requests( 0 ),
+        timer_tick_ms( 10 ),
+        call_setup_timeout_ms( 30000 ),
+        no_answer_timeout_ms( 90000 ),
+        drop_timeout_ms( 10000 ),
+        async_callback( false ),
+        max_callback_batch_size( 32 ),
+        max_callback_queue_size( 65536 ),
+        callback_pool_size( 0 ),
+        voicemail_policy( voicemail_policy_e::NONE ),
+        voicemail_prompt_ms( 10000 )
+    {
+    }
+
+    uint16_t    data_port;              // 0 - do not redirect input data
+    uint32_t    request_timeout_ms;     // default deadline of forwarded requests, 0 - no deadline
+    uint32_t    max_pending_requests;   // requests queued while another one is processed, 0 - reject them
+    uint32_t    timer_tick_ms;          // resolution of per-call timers
+
+    // watchdogs, 0 - disabled
+    uint32_t    call_setup_timeout_ms;  // max time in WAITING_INITIATE_CALL_RESPONSE
+    uint32_t    no_answer_timeout_ms;   // max time in WAITING_CONNECTION
+    uint32_t    drop_timeout_ms;        // max time in CANCELED_IN_WC or CANCELED_IN_C
+
+    bool        async_callback;         // deliver callbacks from a separate thread
+    uint32_t    max_callback_batch_size;    // objects handed over at once to IBatchCallback
+    uint32_t    max_callback_queue_size;    // objects queued per asynchronous subscriber, above it informational events are dropped, 0 - unlimited
+    uint32_t    callback_pool_size;     // released callback objects kept per type, 0 - no pooling
+
+    voicemail_policy_e  voicemail_policy;
+    std::string voicemail_prompt;       // file played by PLAY_AND_DROP, empty - drop at once
+    uint32_t    voicemail_prompt_ms;    // the call is dropped after this time even if the prompt did not end
+};
+
+NAMESPACE_DIALER_END
+
+#endif // LIB_DIALER_CONFIG_H
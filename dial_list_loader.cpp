@@ -0,0 +1,336 @@
+/*
+
+Dial list loader.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+// $Revision: 12038 $ $Date:: 2019-09-25 #$ $Author: serge $
+
+#include "dial_list_loader.h"       // self
+
+#include <cstring>                  // memchr
+#include <sys/mman.h>               // mmap
+#include <sys/stat.h>               // fstat
+#include <fcntl.h>                  // open
+#include <unistd.h>                 // close
+
+#include "../utils/dummy_logger.h"  // dummy_log
+#include "../utils/mutex_helper.h"  // MUTEX_SCOPE_LOCK
+
+#include "campaign.h"               // Campaign
+#include "party.h"                  // normalize_party
+
+#define MODULENAME      "DialListLoader"
+
+NAMESPACE_DIALER_START
+
+DialListLoader::DialListLoader():
+    fd_( -1 ),
+    data_( nullptr ),
+    size_( 0 ),
+    num_threads_( 0 ),
+    chunk_size_( 0 ),
+    num_chunks_( 0 ),
+    max_ready_chunks_( 0 ),
+    campaign_( nullptr ),
+    next_chunk_( 0 ),
+    next_ready_( 0 ),
+    pos_in_ready_( 0 ),
+    must_stop_( false ),
+    num_lines_( 0 ),
+    num_invalid_( 0 ),
+    num_parsed_chunks_( 0 ),
+    parse_time_ms_( 0 )
+{
+}
+
+DialListLoader::~DialListLoader()
+{
+    shutdown();
+
+    if( data_ )
+        munmap( const_cast<char*>( data_ ), size_ );
+
+    if( fd_ >= 0 )
+        close( fd_ );
+}
+
+bool DialListLoader::init(
+        const std::string   & filename,
+        uint32_t            num_threads,
+        uint32_t            chunk_size,
+        uint32_t            max_ready_chunks )
+{
+    if( num_threads == 0 || chunk_size == 0 || max_ready_chunks == 0 )
+        return false;
+
+    fd_ = open( filename.c_str(), O_RDONLY );
+
+    if( fd_ < 0 )
+    {
+        dummy_log_error( MODULENAME, "cannot open %s", filename.c_str() );
+        return false;
+    }
+
+    struct stat st;
+
+    if( fstat( fd_, & st ) != 0 )
+    {
+        dummy_log_error( MODULENAME, "cannot stat %s", filename.c_str() );
+        return false;
+    }
+
+    size_   = st.st_size;
+
+    if( size_ > 0 )
+    {
+        void * p = mmap( nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0 );
+
+        if( p == MAP_FAILED )
+        {
+            dummy_log_error( MODULENAME, "cannot map %s", filename.c_str() );
+            return false;
+        }
+
+        madvise( p, size_, MADV_SEQUENTIAL );
+
+        data_   = static_cast<const char*>( p );
+    }
+
+    num_threads_        = num_threads;
+    chunk_size_         = chunk_size;
+    num_chunks_         = static_cast<uint32_t>( ( size_ + chunk_size - 1 ) / chunk_size );
+    max_ready_chunks_   = max_ready_chunks;
+
+    dummy_log_info( MODULENAME, "init: %s, %llu bytes, %u chunk(s), %u thread(s)",
+            filename.c_str(), (unsigned long long) size_, num_chunks_, num_threads );
+
+    return true;
+}
+
+void DialListLoader::set_campaign( Campaign * campaign )
+{
+    campaign_   = campaign;
+}
+
+void DialListLoader::start()
+{
+    dummy_log_debug( MODULENAME, "start()" );
+
+    start_time_ = std::chrono::steady_clock::now();
+
+    for( uint32_t i = 0; i < num_threads_; ++i )
+        threads_.push_back( std::thread( & DialListLoader::worker_thread, this ) );
+}
+
+void DialListLoader::shutdown()
+{
+    {
+        MUTEX_SCOPE_LOCK( mutex_ );
+
+        must_stop_  = true;
+    }
+
+    cond_.notify_all();
+
+    for( auto & t : threads_ )
+        t.join();
+
+    threads_.clear();
+}
+
+bool DialListLoader::get_parties( std::vector<std::string> * parties, uint32_t max_size )
+{
+    bool is_chunk_released = false;
+    uint32_t n = 0;
+
+    {
+        MUTEX_SCOPE_LOCK( mutex_ );
+
+        while( n < max_size )
+        {
+            auto it = ready_.find( next_ready_ );
+
+            if( it == ready_.end() )
+                break;
+
+            const auto & c = it->second;
+
+            for( ; pos_in_ready_ < c.ends.size() && n < max_size; ++pos_in_ready_, ++n )
+            {
+                uint32_t begin = ( pos_in_ready_ == 0 ) ? 0 : c.ends[ pos_in_ready_ - 1 ];
+
+                parties->push_back( c.data.substr( begin, c.ends[ pos_in_ready_ ] - begin ) );
+            }
+
+            if( pos_in_ready_ < c.ends.size() )
+                break;
+
+            ready_.erase( it );
+
+            ++next_ready_;
+            pos_in_ready_       = 0;
+            is_chunk_released   = true;
+        }
+
+        if( n == 0 && next_ready_ >= num_chunks_ )
+            return false;
+    }
+
+    // a parser may be waiting for a free slot
+    if( is_chunk_released )
+        cond_.notify_all();
+
+    return true;
+}
+
+uint64_t DialListLoader::get_num_lines() const
+{
+    return num_lines_.load( std::memory_order_relaxed );
+}
+
+uint64_t DialListLoader::get_num_invalid() const
+{
+    return num_invalid_.load( std::memory_order_relaxed );
+}
+
+bool DialListLoader::is_parsed() const
+{
+    return num_parsed_chunks_.load() == num_chunks_;
+}
+
+std::chrono::milliseconds DialListLoader::get_parse_time() const
+{
+    return std::chrono::milliseconds( parse_time_ms_.load() );
+}
+
+void DialListLoader::worker_thread()
+{
+    while( true )
+    {
+        uint32_t idx;
+
+        {
+            std::unique_lock<std::mutex> lock( mutex_ );
+
+            // do not run ahead of the consumer by more than max_ready_chunks_
+            cond_.wait( lock, [this]()
+                    {
+                        return must_stop_ || next_chunk_ >= num_chunks_ || next_chunk_ < next_ready_ + max_ready_chunks_;
+                    } );
+
+            if( must_stop_ || next_chunk_ >= num_chunks_ )
+                break;
+
+            idx = next_chunk_++;
+        }
+
+        Chunk chunk;
+
+        parse_chunk( idx, & chunk );
+
+        bool is_next = false;
+
+        {
+            MUTEX_SCOPE_LOCK( mutex_ );
+
+            is_next = ( idx == next_ready_ );
+
+            ready_[ idx ]   = std::move( chunk );
+        }
+
+        if( ++num_parsed_chunks_ == num_chunks_ )
+        {
+            parse_time_ms_  = std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::steady_clock::now() - start_time_ ).count();
+
+            dummy_log_info( MODULENAME, "parsed %llu line(s) in %u ms, %llu invalid",
+                    (unsigned long long) num_lines_.load(), parse_time_ms_.load(), (unsigned long long) num_invalid_.load() );
+        }
+
+        if( is_next && campaign_ )
+            campaign_->resume();
+    }
+}
+
+void DialListLoader::parse_chunk( uint32_t idx, Chunk * chunk )
+{
+    // lines starting in [begin, end) belong to the chunk, the last one may run beyond end
+    size_t begin    = static_cast<size_t>( idx ) * chunk_size_;
+    size_t end      = std::min( begin + chunk_size_, size_ );
+
+    size_t pos      = begin;
+
+    if( pos > 0 && data_[ pos - 1 ] != '\n' )
+    {
+        auto nl = static_cast<const char*>( memchr( data_ + pos, '\n', size_ - pos ) );
+
+        pos = nl ? ( nl - data_ ) + 1 : size_;
+    }
+
+    uint64_t num_lines      = 0;
+    uint64_t num_invalid    = 0;
+
+    std::string party;
+
+    while( pos < end )
+    {
+        auto nl = static_cast<const char*>( memchr( data_ + pos, '\n', size_ - pos ) );
+
+        size_t line_end = nl ? nl - data_ : size_;
+
+        auto comma = static_cast<const char*>( memchr( data_ + pos, ',', line_end - pos ) );
+
+        size_t field_end = comma ? comma - data_ : line_end;
+
+        if( line_end > pos && data_[ pos ] != '#' && !( line_end == pos + 1 && data_[ pos ] == '\r' ) )
+        {
+            ++num_lines;
+
+            if( normalize_party( data_ + pos, field_end - pos, & party ) )
+            {
+                chunk->data.append( party );
+                chunk->ends.push_back( chunk->data.size() );
+            }
+            else
+            {
+                ++num_invalid;
+            }
+        }
+
+        pos = line_end + 1;
+    }
+
+    num_lines_.fetch_add( num_lines, std::memory_order_relaxed );
+    num_invalid_.fetch_add( num_invalid, std::memory_order_relaxed );
+
+    release_pages( begin, std::min( pos, size_ ) );
+}
+
+void DialListLoader::release_pages( size_t begin, size_t end )
+{
+    // whole pages only, the neighbour chunks may still need the partial ones
+    static const size_t page = sysconf( _SC_PAGESIZE );
+
+    size_t b = ( begin + page - 1 ) / page * page;
+    size_t e = end / page * page;
+
+    if( e > b )
+        madvise( const_cast<char*>( data_ ) + b, e - b, MADV_DONTNEED );
+}
+
+NAMESPACE_DIALER_END
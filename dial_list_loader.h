@@ -0,0 +1,126 @@
+/*
+
+Dial list loader.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+// $Revision: 12038 $ $Date:: 2019-09-25 #$ $Author: serge $
+
+#ifndef LIB_DIALER_DIAL_LIST_LOADER_H
+#define LIB_DIALER_DIAL_LIST_LOADER_H
+
+#include <cstdint>                  // uint32_t
+#include <string>                   // std::string
+#include <vector>                   // std::vector
+#include <map>                      // std::map
+#include <mutex>                    // std::mutex
+#include <condition_variable>       // std::condition_variable
+#include <thread>                   // std::thread
+#include <atomic>                   // std::atomic
+#include <chrono>                   // std::chrono::steady_clock
+
+#include "i_party_source.h"         // IPartySource
+
+#include "namespace_lib.h"          // NAMESPACE_DIALER_START
+
+NAMESPACE_DIALER_START
+
+class Campaign;
+
+// Streams the parties of a newline separated file (the first CSV field of each line,
+// lines starting with '#' are comments). The file is mapped and cut into chunks which
+// are validated and normalized by several threads; parties are given out in file order.
+// At most max_ready_chunks parsed chunks are kept and the mapped pages of parsed chunks
+// are dropped, so memory does not grow with the size of the list.
+class DialListLoader:
+        virtual public IPartySource
+{
+public:
+    DialListLoader();
+    ~DialListLoader();
+
+    bool init(
+            const std::string   & filename,
+            uint32_t            num_threads,
+            uint32_t            chunk_size          = 1 << 22,
+            uint32_t            max_ready_chunks    = 16 );
+
+    // the campaign is resumed when parties become available, set before start()
+    void set_campaign( Campaign * campaign );
+
+    void start();
+    void shutdown();
+
+    // interface IPartySource
+    virtual bool get_parties( std::vector<std::string> * parties, uint32_t max_size );
+
+    // lock-free
+    uint64_t get_num_lines() const;
+    uint64_t get_num_invalid() const;
+    bool is_parsed() const;
+
+    // time from start() until all chunks were parsed, 0 - not finished
+    std::chrono::milliseconds get_parse_time() const;
+
+private:
+    // normalized parties of a chunk, stored back to back
+    struct Chunk
+    {
+        std::string             data;
+        std::vector<uint32_t>   ends;
+    };
+
+private:
+    void worker_thread();
+    void parse_chunk( uint32_t idx, Chunk * chunk );
+    void release_pages( size_t begin, size_t end );
+
+private:
+    std::mutex                  mutex_;
+    std::condition_variable     cond_;
+
+    int                         fd_;
+    const char                  * data_;
+    size_t                      size_;
+
+    uint32_t                    num_threads_;
+    uint32_t                    chunk_size_;
+    uint32_t                    num_chunks_;
+    uint32_t                    max_ready_chunks_;
+
+    Campaign                    * campaign_;
+
+    uint32_t                    next_chunk_;        // to be parsed
+    uint32_t                    next_ready_;        // to be given out
+    uint32_t                    pos_in_ready_;      // parties of next_ready_ already given out
+    std::map<uint32_t,Chunk>    ready_;             // parsed chunks, not given out yet
+    bool                        must_stop_;
+
+    std::vector<std::thread>    threads_;
+
+    std::chrono::steady_clock::time_point   start_time_;
+
+    std::atomic<uint64_t>       num_lines_;
+    std::atomic<uint64_t>       num_invalid_;
+    std::atomic<uint32_t>       num_parsed_chunks_;
+    std::atomic<uint32_t>       parse_time_ms_;
+};
+
+NAMESPACE_DIALER_END
+
+#endif // LIB_DIALER_DIAL_LIST_LOADER_H
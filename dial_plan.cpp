@@ -0,0 +1,238 @@
+/*
+
+Dial plan.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+// $Revision: 12038 $ $Date:: 2019-09-25 #$ $Author: serge $
+
+#include "dial_plan.h"              // self
+
+#include <fstream>                  // std::ifstream
+#include <sstream>                  // std::istringstream
+#include <cstdlib>                  // strtoul, strtod
+#include <cmath>                    // std::isfinite
+
+#include "../utils/dummy_logger.h"  // dummy_log
+
+#include "party.h"                  // is_all_digits
+
+#define MODULENAME      "DialPlan"
+
+NAMESPACE_DIALER_START
+
+DialPlan::DialPlan()
+{
+}
+
+std::shared_ptr<const DialPlan> DialPlan::create( const std::vector<Route> & routes )
+{
+    std::shared_ptr<DialPlan> res( new DialPlan );
+
+    res->routes_    = routes;
+    res->nodes_.push_back( Node { { 0 }, -1 } );
+
+    for( uint32_t i = 0; i < routes.size(); ++i )
+    {
+        const auto & r = routes[ i ];
+
+        if( is_all_digits( r.prefix.c_str(), r.prefix.size() ) == false || r.strip > r.prefix.size() || std::isfinite( r.max_rate ) == false || r.max_rate < 0 )
+        {
+            dummy_log_error( MODULENAME, "invalid route '%s'", r.prefix.c_str() );
+            return nullptr;
+        }
+
+        uint32_t node = 0;
+
+        for( auto c : r.prefix )
+        {
+            uint32_t d = c - '0';
+
+            if( res->nodes_[ node ].child[ d ] == 0 )
+            {
+                res->nodes_[ node ].child[ d ] = res->nodes_.size();
+
+                res->nodes_.push_back( Node { { 0 }, -1 } );
+            }
+
+            node = res->nodes_[ node ].child[ d ];
+        }
+
+        if( res->nodes_[ node ].route >= 0 )
+        {
+            dummy_log_error( MODULENAME, "duplicate route '%s'", r.prefix.c_str() );
+            return nullptr;
+        }
+
+        res->nodes_[ node ].route = i;
+    }
+
+    dummy_log_info( MODULENAME, "created: %u route(s), %u node(s)", (unsigned) routes.size(), (unsigned) res->nodes_.size() );
+
+    return res;
+}
+
+std::shared_ptr<const DialPlan> DialPlan::load( const std::string & filename )
+{
+    std::ifstream f( filename );
+
+    if( f.is_open() == false )
+    {
+        dummy_log_error( MODULENAME, "cannot open %s", filename.c_str() );
+        return nullptr;
+    }
+
+    std::vector<Route> routes;
+
+    std::string line;
+
+    uint32_t line_num = 0;
+
+    while( std::getline( f, line ) )
+    {
+        ++line_num;
+
+        if( line.empty() == false && line.back() == '\r' )
+            line.pop_back();
+
+        if( line.empty() || line[0] == '#' )
+            continue;
+
+        Route r;
+
+        if( parse_line( line, & r ) == false )
+        {
+            dummy_log_error( MODULENAME, "%s:%u: invalid route '%s'", filename.c_str(), line_num, line.c_str() );
+            return nullptr;
+        }
+
+        routes.push_back( r );
+    }
+
+    return create( routes );
+}
+
+const DialPlan::Route * DialPlan::find( const PhoneNumber & number ) const
+{
+    if( number.is_valid() == false )
+        return nullptr;
+
+    char digits[ PhoneNumber::MAX_DIGITS ];
+
+    uint32_t len    = number.format_digits( digits );
+
+    uint32_t node   = 0;
+    int32_t res     = nodes_[0].route;
+
+    for( uint32_t i = 0; i < len; ++i )
+    {
+        node = nodes_[ node ].child[ digits[i] - '0' ];
+
+        if( node == 0 )
+            break;
+
+        if( nodes_[ node ].route >= 0 )
+            res = nodes_[ node ].route;
+    }
+
+    return ( res >= 0 ) ? & routes_[ res ] : nullptr;
+}
+
+std::string DialPlan::apply( const Route & route, const PhoneNumber & number )
+{
+    // the matched prefix is at least route.strip digits long
+    return route.prepend + number.get_digits().substr( route.strip );
+}
+
+uint32_t DialPlan::get_num_routes() const
+{
+    return routes_.size();
+}
+
+const DialPlan::Route & DialPlan::get_route( uint32_t i ) const
+{
+    return routes_[ i ];
+}
+
+static bool to_uint( const std::string & s, uint32_t * res )
+{
+    if( s.empty() || is_all_digits( s.c_str(), s.size() ) == false || s.size() > 9 )
+        return false;
+
+    * res = strtoul( s.c_str(), nullptr, 10 );
+
+    return true;
+}
+
+bool DialPlan::parse_line( const std::string & line, Route * route )
+{
+    std::vector<std::string> fields;
+
+    std::istringstream is( line );
+
+    std::string field;
+
+    while( std::getline( is, field, ',' ) )
+        fields.push_back( field );
+
+    // a trailing empty accounts field is dropped by getline
+    if( fields.size() == 4 )
+        fields.push_back( std::string() );
+
+    if( fields.size() != 5 && fields.size() != 7 )
+        return false;
+
+    route->max_rate = 0;
+    route->burst    = 1;
+
+    if( fields.size() == 7 )
+    {
+        char * end;
+
+        route->max_rate = strtod( fields[5].c_str(), & end );
+
+        if( fields[5].empty() || * end != '\0' || std::isfinite( route->max_rate ) == false || route->max_rate < 0 || to_uint( fields[6], & route->burst ) == false )
+            return false;
+    }
+
+    route->prefix   = ( fields[0] == "*" ) ? std::string() : fields[0];
+    route->prepend  = fields[2];
+
+    if( to_uint( fields[1], & route->strip ) == false || to_uint( fields[3], & route->max_calls ) == false )
+        return false;
+
+    if( is_all_digits( route->prepend.c_str(), route->prepend.size() ) == false )
+        return false;
+
+    std::istringstream as( fields[4] );
+
+    while( std::getline( as, field, ':' ) )
+    {
+        uint32_t account;
+
+        if( to_uint( field, & account ) == false )
+            return false;
+
+        route->accounts.push_back( account );
+    }
+
+    return true;
+}
+
+NAMESPACE_DIALER_END
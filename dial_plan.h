@@ -0,0 +1,93 @@
+/*
+
+Dial plan.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+// $Revision: 12038 $ $Date:: 2019-09-25 #$ $Author: serge $
+
+#ifndef LIB_DIALER_DIAL_PLAN_H
+#define LIB_DIALER_DIAL_PLAN_H
+
+#include <cstdint>                  // uint32_t
+#include <string>                   // std::string
+#include <vector>                   // std::vector
+#include <memory>                   // std::shared_ptr
+
+#include "phone_number.h"           // PhoneNumber
+
+#include "namespace_lib.h"          // NAMESPACE_DIALER_START
+
+NAMESPACE_DIALER_START
+
+// Maps phone numbers to routes by the longest matching prefix of their digits.
+// The prefixes are compiled into a digit trie with one small node per digit,
+// so a lookup costs a cache miss per matched digit at most.
+// The object is immutable, a new plan is swapped in by replacing the shared pointer.
+class DialPlan
+{
+public:
+    struct Route
+    {
+        std::string             prefix;     // digits without "+", empty - default route
+        uint32_t                strip;      // leading digits removed, not more than the prefix
+        std::string             prepend;    // put in front of the remaining digits
+        uint32_t                max_calls;  // simultaneous calls, 0 - unlimited
+        std::vector<uint32_t>   accounts;   // account indexes, cheapest first, empty - any account
+        double                  max_rate;   // calls per second, 0 - unlimited
+        uint32_t                burst;      // calls allowed back to back, 0 - same as 1
+    };
+
+public:
+    // nullptr if the routes are invalid or a prefix is duplicated
+    static std::shared_ptr<const DialPlan> create( const std::vector<Route> & routes );
+
+    // one route per line: prefix,strip,prepend,max_calls,accounts[,max_rate,burst]
+    // e.g. "49,2,0049,10,2:0,5,10"; prefix "*" - default route, lines starting with '#' are comments
+    static std::shared_ptr<const DialPlan> load( const std::string & filename );
+
+    // nullptr - no route, i.e. the number must not be dialed
+    const Route * find( const PhoneNumber & number ) const;
+
+    // number in the form expected by the voip service
+    static std::string apply( const Route & route, const PhoneNumber & number );
+
+    uint32_t get_num_routes() const;
+    const Route & get_route( uint32_t i ) const;
+
+private:
+    struct Node
+    {
+        uint32_t    child[10];  // 0 - none, the root is never a child
+        int32_t     route;      // -1 - none
+    };
+
+private:
+    DialPlan();
+
+    static bool parse_line( const std::string & line, Route * route );
+
+private:
+    std::vector<Route>  routes_;
+    std::vector<Node>   nodes_;     // nodes_[0] - root
+};
+
+NAMESPACE_DIALER_END
+
+#endif // LIB_DIALER_DIAL_PLAN_H
@@ -23,7 +23,6 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 
 #include "dialer.h"                     // self
 
-#include "../simple_voip/object_factory.h"      // simple_voip::create_message_t
 #include "../skype_service/skype_service.h"     // skype_service::SkypeService
 #include "../skype_service/str_helper.h"        // skype_service::to_string
 #include "../utils/dummy_logger.h"      // dummy_log
@@ -31,12 +30,17 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 #include "../utils/utils_assert.h"            // ASSERT
 
 #include "str_helper.h"                 // StrHelper
-#include "regex_match.h"                // regex_match
+#include "party.h"                      // transform_party, get_party_type
+#include "error_codes.h"                // ERROR_CODE_REQUEST_EXPIRED, ...
+#include "failure_reason.h"             // decode_failure_reason
 
 #include "namespace_lib.h"              // NAMESPACE_DIALER_START
 
 #define MODULENAME      "Dialer"
 
+#define HANGUP_JOB_ID_BASE  ( 0xFF000000 )     // internal requests, not expected to clash with client ones
+#define ABANDONED_TTL_MS    ( 300000 )          // late replies of abandoned requests and calls are not expected after that
+
 NAMESPACE_DIALER_START
 
 struct DetectedTone: public workt::IObject
@@ -50,35 +54,84 @@ struct ObjectWrap: public workt::IObject
     const skype_service::Event *ev;
 };
 
+// asynchronous delivery to a typed subscriber
+struct AsyncTypedCallback
+{
+    TypedCallbackAdapter    adapter;
+    AsyncCallback           async_callback;     // destroyed first, flushes into adapter
+};
+
+// periodic tick driving the timer wheel
+struct TimerTick: public workt::IObject
+{
+};
+
 // object wrapper for simple_voip::ForwardObject messages
 struct SimpleVoipWrap: public workt::IObject
 {
     const simple_voip::ForwardObject *obj;
+    std::chrono::steady_clock::time_point   deadline;   // default value - no deadline
 };
 
 class Dialer;
 
 Dialer::Dialer():
     WorkerBase( this ),
-    state_( UNKNOWN ), sio_( 0L ), sched_( 0L ), callback_( 0L ),
-    data_port_( 0 ),
+    is_inited_( false ),
+    state_( UNKNOWN ), sio_( 0L ), sched_( 0L ),
     current_job_id_( 0 ),
     call_id_( 0 ),
+    max_call_id_( 0 ),
     cs_( skype_service::conn_status_e::NONE ),
     us_( skype_service::user_status_e::NONE ),
-    failure_reason_( 0 ),
-    pstn_status_( 0 )
+    failure_reason_( failure_reason_e::NONE ),
+    pstn_status_( 0 ),
+    outcome_req_id_( 0 ),
+    is_call_connected_( false ),
+    dnc_list_version_( 0 ),
+    dnc_list_cached_version_( 0 ),
+    dial_plan_version_( 0 ),
+    dial_plan_cached_version_( 0 ),
+    watchdog_id_( 0 ),
+    voicemail_duration_( 0 ),
+    is_voicemail_prompt_( false ),
+    voicemail_timer_id_( 0 ),
+    last_hangup_job_id_( HANGUP_JOB_ID_BASE ),
+    must_stop_ticker_( false ),
+    is_tick_pending_( false ),
+    ready_future_( ready_promise_.get_future().share() ),
+    is_ready_signalled_( false ),
+    startup_time_ms_( 0 )
 {
 }
 
 Dialer::~Dialer()
 {
+    must_stop_ticker_   = true;
+
+    if( ticker_.joinable() )
+        ticker_.join();
+
+    for( auto & r : pending_requests_ )
+        delete r.obj;
 }
 
 bool Dialer::init(
         skype_service::SkypeService * sw,
         scheduler::IScheduler       * sched,
         uint16_t                    data_port )
+{
+    Config config;
+
+    config.data_port    = data_port;
+
+    return init( sw, sched, config );
+}
+
+bool Dialer::init(
+        skype_service::SkypeService * sw,
+        scheduler::IScheduler       * sched,
+        const Config                & config )
 {
 	MUTEX_SCOPE_LOCK( mutex_ );
 
@@ -90,37 +143,122 @@ bool Dialer::init(
     sio_        = sw;
     sched_      = sched;
     state_      = UNKNOWN;
-    data_port_  = data_port;
+    config_     = config;
+
+    timers_.init( config.timer_tick_ms, std::chrono::steady_clock::now() );
+
+    pool_.init( config.callback_pool_size );
+
+    dispatcher_.init( & pool_ );
 
-    player_.init( sio_, sched );
+    player_.init( sio_, & timers_, & pool_, & dispatcher_ );
 
-    dummy_log_info( MODULENAME, "init: port %u", data_port );
+    publish_snapshot();
+
+    is_inited_  = true;
+
+    dummy_log_info( MODULENAME, "init: port %u, request timeout %u ms", config.data_port, config.request_timeout_ms );
 
     return true;
 }
 
-bool Dialer::register_callback( simple_voip::ISimpleVoipCallback * callback )
+bool Dialer::register_callback( simple_voip::ISimpleVoipCallback * callback, uint32_t mask )
 {
-    if( callback == 0L )
+    if( callback == 0L || mask == 0 )
         return false;
 
-    MUTEX_SCOPE_LOCK( mutex_ );
+    CallbackDispatcher::Subscriber s;
+
+    s.key               = callback;
+    s.callback          = callback;
+    s.typed_callback    = nullptr;
+    s.mask              = mask;
+    s.async             = nullptr;
+
+    if( config_.async_callback )
+    {
+        // client code is run by the delivery thread, the worker never waits for it
+        auto async = std::make_shared<AsyncCallback>();
+
+        if( async->init( callback, config_.max_callback_batch_size, config_.max_callback_queue_size ) == false )
+            return false;
+
+        async->start();
+
+        s.callback  = async.get();
+        s.async     = async.get();
+        s.holder    = async;
+    }
+
+    return dispatcher_.add_subscriber( s );
+}
+
+bool Dialer::register_callback( ITypedCallback * callback, uint32_t mask )
+{
+    if( callback == 0L || mask == 0 )
+        return false;
+
+    CallbackDispatcher::Subscriber s;
+
+    s.key               = callback;
+    s.callback          = nullptr;
+    s.typed_callback    = callback;
+    s.mask              = mask;
+    s.async             = nullptr;
+
+    if( config_.async_callback )
+    {
+        // the static type is lost in the queue, the adapter restores it on the delivery thread
+        auto async = std::make_shared<AsyncTypedCallback>();
+
+        async->adapter.init( callback, & pool_ );
+
+        if( async->async_callback.init( & async->adapter, config_.max_callback_batch_size, config_.max_callback_queue_size ) == false )
+            return false;
+
+        async->async_callback.start();
+
+        s.callback          = & async->async_callback;
+        s.typed_callback    = nullptr;
+        s.async             = & async->async_callback;
+        s.holder            = async;
+    }
+
+    return dispatcher_.add_subscriber( s );
+}
+
+bool Dialer::unregister_callback( simple_voip::ISimpleVoipCallback * callback )
+{
+    return dispatcher_.remove_subscriber( callback );
+}
+
+bool Dialer::unregister_callback( ITypedCallback * callback )
+{
+    return dispatcher_.remove_subscriber( callback );
+}
 
-    if( callback_ != 0L )
+bool Dialer::register_outcome_callback( IOutcomeCallback * callback )
+{
+    if( callback == 0L )
         return false;
 
-    callback_ = callback;
+    MUTEX_SCOPE_LOCK( mutex_ );
 
-    player_.register_callback( callback );
+    outcome_callbacks_.push_back( callback );
 
     return true;
 }
 
-bool Dialer::is_inited() const
+void Dialer::set_max_call_id( uint32_t max_call_id )
 {
     MUTEX_SCOPE_LOCK( mutex_ );
 
-    return is_inited__();
+    max_call_id_    = max_call_id;
+}
+
+bool Dialer::is_inited() const
+{
+    return is_inited_;
 }
 
 bool Dialer::is_inited__() const
@@ -133,17 +271,61 @@ bool Dialer::is_inited__() const
 
 Dialer::state_e Dialer::get_state() const
 {
-    MUTEX_SCOPE_LOCK( mutex_ );
+    return snapshot_.load().state;
+}
+
+Dialer::Snapshot Dialer::get_snapshot() const
+{
+    return snapshot_.load();
+}
+
+void Dialer::publish_snapshot()
+{
+    publish_snapshot( state_ );
+}
+
+void Dialer::publish_snapshot( state_e state )
+{
+    // private: called by the worker thread only
+
+    Snapshot s;
 
-    return state_;
+    s.state             = state;
+    s.call_id           = call_id_;
+    s.pstn_status       = pstn_status_;
+    s.failure_reason    = failure_reason_;
+
+    snapshot_.store( s );
+}
+
+const Stats & Dialer::get_stats() const
+{
+    return stats_;
+}
+
+void Dialer::release( const simple_voip::CallbackObject * obj )
+{
+    pool_.release( obj );
 }
 
 // interface ISimpleVoip
 void Dialer::consume( const simple_voip::ForwardObject * req )
+{
+    if( config_.request_timeout_ms == 0 )
+    {
+        consume( req, std::chrono::steady_clock::time_point() );
+        return;
+    }
+
+    consume( req, std::chrono::steady_clock::now() + std::chrono::milliseconds( config_.request_timeout_ms ) );
+}
+
+void Dialer::consume( const simple_voip::ForwardObject * req, const std::chrono::steady_clock::time_point & deadline )
 {
     auto w = new SimpleVoipWrap;
 
-    w->obj  = req;
+    w->obj      = req;
+    w->deadline = deadline;
 
     WorkerBase::consume( w );
 }
@@ -182,6 +364,10 @@ void Dialer::handle( const workt::IObject* req )
     {
         handle( dynamic_cast< const DetectedTone *>( req ) );
     }
+    else if( typeid( *req ) == typeid( TimerTick ) )
+    {
+        handle( dynamic_cast< const TimerTick *>( req ) );
+    }
     else
     {
         dummy_log_fatal( MODULENAME, "handle: cannot cast request to known type - %s", typeid( *req ).name() );
@@ -189,6 +375,10 @@ void Dialer::handle( const workt::IObject* req )
         ASSERT( 0 );
     }
 
+    process_pending_requests();
+
+    publish_snapshot();
+
     delete req;
 }
 
@@ -200,21 +390,53 @@ void Dialer::handle( const simple_voip::InitiateCallRequest * req )
     // private: no mutex lock
 
     if( send_reject_if_in_request_processing( req->req_id ) )
+    {
+        send_outcome( req->req_id, call_result_e::REJECTED );
         return;
+    }
 
     if( state_ != IDLE )
     {
         send_reject_due_to_wrong_state( req->req_id );
+        send_outcome( req->req_id, call_result_e::REJECTED );
         return;
     }
 
-    std::string party;
+    PhoneNumber number;     // stays invalid for symbolic parties
 
-    if( transform_party( req->party, party ) == false )
+    // numbers are parsed once, longer ones than PhoneNumber can hold are not valid
+    if( PhoneNumber::parse( req->party, & number ) == false && get_party_type( req->party ) != party_e::SYMBOLIC )
     {
         dummy_log_error( MODULENAME, "invalid number format: %s", req->party.c_str() );
 
-        callback_consume( simple_voip::create_error_response( req->req_id, 0, "invalid number format: " + req->party ) );
+        CALLBACK_SEND( dispatcher_, pool_.create_error_response( req->req_id, 0, "invalid number format: " + req->party ) );
+        send_outcome( req->req_id, call_result_e::SETUP_ERROR );
+
+        return;
+    }
+
+    if( is_do_not_call( number ) )
+    {
+        dummy_log_info( MODULENAME, "req id %u: %s is on do-not-call list", req->req_id, req->party.c_str() );
+
+        stats_.inc( counter_e::DNC_BLOCKED );
+
+        CALLBACK_SEND( dispatcher_, pool_.create_error_response( req->req_id, ERROR_CODE_DO_NOT_CALL, "party is on do-not-call list" ) );
+        send_outcome( req->req_id, call_result_e::BLOCKED );
+
+        return;
+    }
+
+    std::string party;
+
+    if( route_party( req->party, number, & party ) == false )
+    {
+        dummy_log_info( MODULENAME, "req id %u: no route for %s", req->req_id, req->party.c_str() );
+
+        stats_.inc( counter_e::NO_ROUTE );
+
+        CALLBACK_SEND( dispatcher_, pool_.create_error_response( req->req_id, ERROR_CODE_NO_ROUTE, "no route for party" ) );
+        send_outcome( req->req_id, call_result_e::BLOCKED );
 
         return;
     }
@@ -227,17 +449,21 @@ void Dialer::handle( const simple_voip::InitiateCallRequest * req )
     {
         dummy_log_error( MODULENAME, "failed calling: %s", req->party.c_str() );
 
-        callback_consume( simple_voip::create_error_response( req->req_id, 0, "voip io failed" ) );
+        CALLBACK_SEND( dispatcher_, pool_.create_error_response( req->req_id, 0, "voip io failed" ) );
+        send_outcome( req->req_id, call_result_e::SETUP_ERROR );
 
         return;
     }
 
     ASSERT( current_job_id_ == 0 );
     current_job_id_    = req->req_id;
+    outcome_req_id_    = req->req_id;
 
-    state_  = WAITING_INITIATE_CALL_RESPONSE;
+    dial_time_          = std::chrono::steady_clock::now();
+    ringing_time_       = std::chrono::steady_clock::time_point();
+    connected_time_     = std::chrono::steady_clock::time_point();
 
-    dummy_log_debug( MODULENAME, "switched to %s", StrHelper::to_string( state_ ).c_str() );
+    next_state( WAITING_INITIATE_CALL_RESPONSE );
 }
 
 void Dialer::handle( const simple_voip::DropRequest * req )
@@ -261,18 +487,19 @@ void Dialer::handle( const simple_voip::DropRequest * req )
 
     if( b == false )
     {
-        callback_consume( simple_voip::create_error_response( req->req_id, 0, "voip io failed" ) );
+        CALLBACK_SEND( dispatcher_, pool_.create_error_response( req->req_id, 0, "voip io failed" ) );
         return;
     }
 
     current_job_id_    = req->req_id;
 
+    // the drop of the client replaces the one at the end of the voicemail prompt
+    cancel_voicemail_prompt();
+
     if( state_ == WAITING_CONNECTION )
-        state_      = CANCELED_IN_WC;
+        next_state( CANCELED_IN_WC );
     else /* if( state_ == CONNECTED ) */
-        state_      = CANCELED_IN_C;
-
-    dummy_log_debug( MODULENAME, "switched to %s", StrHelper::to_string( state_ ).c_str() );
+        next_state( CANCELED_IN_C );
 }
 
 void Dialer::handle( const simple_voip::PlayFileRequest * req )
@@ -284,7 +511,8 @@ void Dialer::handle( const simple_voip::PlayFileRequest * req )
     if( send_reject_if_in_request_processing( req->req_id ) )
         return;
 
-    if( state_ != CONNECTED )
+    // the call is dropped at the end of the voicemail prompt
+    if( state_ != CONNECTED || is_voicemail_prompt_ )
     {
         send_reject_due_to_wrong_state( req->req_id );
         return;
@@ -292,7 +520,8 @@ void Dialer::handle( const simple_voip::PlayFileRequest * req )
 
     ASSERT( is_call_id_valid( req->call_id ) );
 
-    player_.play_file( req->req_id, req->call_id, req->filename );
+    if( player_.play_file( req->req_id, req->call_id, req->filename ) )
+        media_ops_[ req->req_id ]   = media_op_e::PLAY;
 }
 
 void Dialer::handle( const simple_voip::PlayFileStopRequest * req )
@@ -312,7 +541,8 @@ void Dialer::handle( const simple_voip::PlayFileStopRequest * req )
 
     ASSERT( is_call_id_valid( req->call_id ) );
 
-    player_.stop( req->req_id, req->call_id );
+    if( player_.stop( req->req_id, req->call_id ) )
+        media_ops_[ req->req_id ]   = media_op_e::PLAY_STOP;
 }
 
 void Dialer::handle( const simple_voip::RecordFileRequest * req )
@@ -338,19 +568,35 @@ void Dialer::handle( const simple_voip::RecordFileRequest * req )
     {
         dummy_log_error( MODULENAME, "failed setting output file: %s", req->filename.c_str() );
 
-        callback_consume( simple_voip::create_error_response( req->req_id, 0, "failed output input file: " + req->filename ) );
+        CALLBACK_SEND( dispatcher_, pool_.create_error_response( req->req_id, 0, "failed output input file: " + req->filename ) );
 
         return;
     }
 
-    callback_consume( simple_voip::create_record_file_response( req->req_id ) );
+    // response is sent on AlterCallSetOutputFileEvent
+    media_ops_[ req->req_id ]   = media_op_e::RECORD;
 }
 
 void Dialer::handle( const SimpleVoipWrap * w )
 {
-    auto * req = w->obj;
+    // private: no mutex lock
 
-    if( typeid( *req ) == typeid( simple_voip::InitiateCallRequest ) )
+    if( config_.max_pending_requests > 0 && ( current_job_id_ != 0 || pending_requests_.empty() == false ) )
+    {
+        enqueue_pending_request( w );
+        return;
+    }
+
+    handle( w->obj, w->deadline );
+}
+
+void Dialer::handle( const simple_voip::ForwardObject * req, const std::chrono::steady_clock::time_point & deadline )
+{
+    if( is_expired( deadline ) )
+    {
+        send_expired_response( req );
+    }
+    else if( typeid( *req ) == typeid( simple_voip::InitiateCallRequest ) )
     {
         handle( dynamic_cast< const simple_voip::InitiateCallRequest *>( req ) );
     }
@@ -388,6 +634,12 @@ void Dialer::handle( const ObjectWrap * req )
 
     ASSERT( ev );
 
+    if( ignore_abandoned_call( ev ) )
+    {
+        delete ev;
+        return;
+    }
+
     switch( state_ )
     {
     case IDLE:
@@ -528,7 +780,7 @@ void Dialer::handle_in_state_w_ical( const skype_service::Event * ev )
             ( typeid( *ev ) == typeid( skype_service::ConnStatusEvent ) ) ||
             ( typeid( *ev ) == typeid( skype_service::UserStatusEvent ) ) )
     {
-        // TODO process disconnect
+        handle_disconnect( ev );
     }
     else if(
             ( typeid( *ev ) == typeid( skype_service::CallEvent ) ) ||
@@ -559,12 +811,11 @@ void Dialer::handle_in_state_w_ical( const skype_service::Event * ev )
 
         dummy_log_error( MODULENAME, "job_id %u, error %u '%s'", current_job_id_, errorcode, descr.c_str() );
 
-        callback_consume( simple_voip::create_error_response( current_job_id_, errorcode, descr ) );
+        CALLBACK_SEND( dispatcher_, pool_.create_error_response( current_job_id_, errorcode, descr ) );
+        finish_outcome( call_result_e::SETUP_ERROR );
 
         current_job_id_ = 0;
-        state_          = IDLE;
-
-        dummy_log_debug( MODULENAME, "switched to %s", StrHelper::to_string( state_ ).c_str() );
+        next_state( IDLE );
     }
 //    else if( typeid( *ev ) == typeid( skype_service::UNDEF:
     else if(
@@ -596,7 +847,7 @@ void Dialer::handle_in_state_w_conn( const skype_service::Event * ev )
             ( typeid( *ev ) == typeid( skype_service::ConnStatusEvent ) ) ||
             ( typeid( *ev ) == typeid( skype_service::UserStatusEvent ) ) )
     {
-        // TODO process disconnect
+        handle_disconnect( ev );
     }
     else if(
             ( typeid( *ev ) == typeid( skype_service::CallEvent ) ) ||
@@ -630,7 +881,8 @@ void Dialer::handle_in_state_w_conn( const skype_service::Event * ev )
 
         dummy_log_error( MODULENAME, "error %u '%s'", errorcode, descr.c_str() );
 
-        callback_consume( simple_voip::create_failed( call_id_, simple_voip::Failed::FAILED, "ERROR: " + descr ) );
+        CALLBACK_SEND( dispatcher_, pool_.create_failed( call_id_, simple_voip::Failed::FAILED, "ERROR: " + descr ) );
+        finish_outcome( call_result_e::FAILED );
 
         switch_to_idle_and_cleanup();
     }
@@ -667,7 +919,7 @@ void Dialer::handle_in_state_connected( const skype_service::Event * ev )
             ( typeid( *ev ) == typeid( skype_service::ConnStatusEvent ) ) ||
             ( typeid( *ev ) == typeid( skype_service::UserStatusEvent ) ) )
     {
-        // TODO process disconnect
+        handle_disconnect( ev );
     }
     else if( typeid( *ev ) == typeid( skype_service::CallEvent ) )
     {
@@ -694,7 +946,7 @@ void Dialer::handle_in_state_connected( const skype_service::Event * ev )
     }
     else if( typeid( *ev ) == typeid( skype_service::ErrorEvent ) )
     {
-        if( ev->req_id == 0 ) // do not handle unexpected responses
+        if( ev->req_id == 0 )
         {
             const skype_service::ErrorEvent * ev_c = dynamic_cast<const skype_service::ErrorEvent*>( ev );
 
@@ -703,10 +955,21 @@ void Dialer::handle_in_state_connected( const skype_service::Event * ev )
 
             dummy_log_error( MODULENAME, "error %u '%s'", errorcode, descr.c_str() );
 
-            callback_consume( simple_voip::create_connection_lost( call_id_, descr ) );
+            CALLBACK_SEND( dispatcher_, pool_.create_connection_lost( call_id_, descr ) );
+            finish_outcome( call_result_e::CONNECTION_LOST );
 
             switch_to_idle_and_cleanup();
         }
+        else
+        {
+            handle_media_response( ev );
+        }
+    }
+    else if(
+            ( typeid( *ev ) == typeid( skype_service::AlterCallSetInputFileEvent ) ) ||
+            ( typeid( *ev ) == typeid( skype_service::AlterCallSetOutputFileEvent ) ) )
+    {
+        handle_media_response( ev );
     }
     else if(
             ( typeid( *ev ) == typeid( skype_service::CurrentUserHandleEvent ) ) ||
@@ -714,9 +977,7 @@ void Dialer::handle_in_state_connected( const skype_service::Event * ev )
             ( typeid( *ev ) == typeid( skype_service::UserEvent ) ) ||
             ( typeid( *ev ) == typeid( skype_service::ChatEvent) ) ||
             ( typeid( *ev ) == typeid( skype_service::ChatMemberEvent ) ) ||
-            ( typeid( *ev ) == typeid( skype_service::CallVaaInputStatusEvent ) ) ||
-            ( typeid( *ev ) == typeid( skype_service::AlterCallSetInputFileEvent ) ) ||
-            ( typeid( *ev ) == typeid( skype_service::AlterCallSetOutputFileEvent ) ) )
+            ( typeid( *ev ) == typeid( skype_service::CallVaaInputStatusEvent ) ) )
     {
         // simply ignore
     }
@@ -741,7 +1002,7 @@ void Dialer::handle_in_state_w_drpr( const skype_service::Event * ev )
             ( typeid( *ev ) == typeid( skype_service::ConnStatusEvent ) ) ||
             ( typeid( *ev ) == typeid( skype_service::UserStatusEvent ) ) )
     {
-        // TODO process disconnect
+        handle_disconnect( ev );
     }
     else if( typeid( *ev ) == typeid( skype_service::CallEvent ) )
     {
@@ -759,6 +1020,14 @@ void Dialer::handle_in_state_w_drpr( const skype_service::Event * ev )
 
         dummy_log_debug( MODULENAME, "call %u vaa_input_status %u", n, s );
 
+        // the voicemail prompt is not played by the player, the pending drop ends the call anyway
+        if( is_voicemail_prompt_ || voicemail_time_ != std::chrono::steady_clock::time_point() )
+        {
+            cancel_voicemail_prompt();
+
+            return;
+        }
+
         if( s )
         {
             // play start is really not expected while waiting for drop response
@@ -777,9 +1046,8 @@ void Dialer::handle_in_state_w_drpr( const skype_service::Event * ev )
             ( typeid( *ev ) == typeid( skype_service::AlterCallSetOutputFileEvent ) ) ||
             ( typeid( *ev ) == typeid( skype_service::AlterCallSetInputFileEvent ) ) )
     {
-        dummy_log_error( MODULENAME, "handle_in_state_w_drpr: event %s, unexpected in state %s",
-                typeid( *ev ).name(), StrHelper::to_string( state_ ).c_str() );
-        ASSERT( 0 );
+        // response to a media request sent before the drop
+        handle_media_response( ev );
     }
     else if( typeid( *ev ) == typeid( skype_service::CallPstnStatusEvent ) )
     {
@@ -796,6 +1064,10 @@ void Dialer::handle_in_state_w_drpr( const skype_service::Event * ev )
         else
             handle_in_w_drpr_2( dynamic_cast<const skype_service::CallStatusEvent*>( ev ) );
     }
+    else if( typeid( *ev ) == typeid( skype_service::ErrorEvent ) && is_media_response( ev ) )
+    {
+        handle_media_response( ev );
+    }
     else if( typeid( *ev ) == typeid( skype_service::ErrorEvent ) )
     {
         const skype_service::ErrorEvent * ev_c = dynamic_cast<const skype_service::ErrorEvent*>( ev );
@@ -805,7 +1077,8 @@ void Dialer::handle_in_state_w_drpr( const skype_service::Event * ev )
 
         dummy_log_error( MODULENAME, "error %u '%s'", errorcode, descr.c_str() );
 
-        callback_consume( simple_voip::create_connection_lost( call_id_, "ERROR: " + std::to_string( errorcode ) + ", " + descr ) );
+        CALLBACK_SEND( dispatcher_, pool_.create_connection_lost( call_id_, "ERROR: " + std::to_string( errorcode ) + ", " + descr ) );
+        finish_outcome( is_call_connected_ ? call_result_e::CONNECTION_LOST : call_result_e::FAILED );
 
         switch_to_idle_and_cleanup();
     }
@@ -828,6 +1101,57 @@ void Dialer::handle_in_state_w_drpr( const skype_service::Event * ev )
     }
 }
 
+void Dialer::handle_disconnect( const skype_service::Event * ev )
+{
+    // private: no mutex lock
+
+    if( typeid( *ev ) == typeid( skype_service::ConnStatusEvent ) )
+        cs_ = dynamic_cast<const skype_service::ConnStatusEvent*>( ev )->status;
+    else
+        us_ = dynamic_cast<const skype_service::UserStatusEvent*>( ev )->status;
+
+    if( is_online() )
+    {
+        dummy_log_debug( MODULENAME, "conn status %u, user status %u, still online", cs_, us_ );
+        return;
+    }
+
+    dummy_log_warn( MODULENAME, "account went offline in state %s, call id %u, job_id %u",
+            StrHelper::to_string( state_ ).c_str(), call_id_, current_job_id_ );
+
+    stats_.inc( counter_e::CALLS_LOST_ON_DISCONNECT );
+
+    // the outcome below releases the account in MultiDialer, which must see it unavailable by then
+    publish_snapshot( UNKNOWN );
+
+    if( state_ == WAITING_INITIATE_CALL_RESPONSE )
+    {
+        // the call may still be placed when the connection is back
+        forget_later( & abandoned_job_ids_, current_job_id_ );
+
+        send_error_response( current_job_id_, ERROR_CODE_ACCOUNT_OFFLINE, "account went offline" );
+        finish_outcome( call_result_e::SETUP_ERROR );
+    }
+    else
+    {
+        // the hang up may fail, late events of the call are ignored anyway
+        abandon_call( call_id_ );
+
+        if( state_ == CANCELED_IN_C || state_ == CANCELED_IN_WC )
+            send_error_response( current_job_id_, ERROR_CODE_ACCOUNT_OFFLINE, "account went offline" );
+
+        CALLBACK_SEND( dispatcher_, pool_.create_connection_lost( call_id_, "account went offline" ) );
+        finish_outcome( is_call_connected_ ? call_result_e::CONNECTION_LOST : call_result_e::FAILED );
+    }
+
+    switch_to_idle_and_cleanup();
+
+    // goes to UNKNOWN at once, so the account is not selected for new calls
+    switch_to_ready_if_possible();
+
+    reject_pending_requests( ERROR_CODE_ACCOUNT_OFFLINE, "account went offline" );
+}
+
 void Dialer::forward_to_player( const skype_service::Event * ev )
 {
     // called from locked area: no mutex lock
@@ -837,7 +1161,9 @@ void Dialer::forward_to_player( const skype_service::Event * ev )
             ( typeid( *ev ) == typeid( skype_service::UserStatusEvent ) ) ||
             ( typeid( *ev ) == typeid( skype_service::CallEvent ) ) ||
             ( typeid( *ev ) == typeid( skype_service::CallDurationEvent ) ) ||
+            ( typeid( *ev ) == typeid( skype_service::AlterCallSetInputFileEvent ) ) ||
             ( typeid( *ev ) == typeid( skype_service::AlterCallSetOutputFileEvent ) ) ||
+            ( typeid( *ev ) == typeid( skype_service::ErrorEvent ) ) ||
             ( typeid( *ev ) == typeid( skype_service::CallPstnStatusEvent ) ) ||
             ( typeid( *ev ) == typeid( skype_service::CallFailureReasonEvent ) ) ||
             ( typeid( *ev ) == typeid( skype_service::CallStatusEvent ) ) ||
@@ -857,28 +1183,90 @@ void Dialer::forward_to_player( const skype_service::Event * ev )
 
         dummy_log_debug( MODULENAME, "call %u vaa_input_status %u", n, s );
 
+        // the voicemail prompt is not played by the player
+        if( is_voicemail_prompt_ )
+        {
+            if( s == 0 )
+                drop_voicemail();
+
+            return;
+        }
+
         if( s )
             player_.on_play_start( n );
         else
             player_.on_play_stop( n );
     }
-    else if( typeid( *ev ) == typeid( skype_service::AlterCallSetInputFileEvent ) )
+}
+
+bool Dialer::is_media_response( const skype_service::Event * ev ) const
+{
+    return ev->req_id != 0 && media_ops_.count( ev->req_id ) > 0;
+}
+
+void Dialer::handle_media_response( const skype_service::Event * ev )
+{
+    // private: no mutex lock
+
+    if( ignore_non_response( ev ) )
+    {
+        return;
+    }
+
+    auto it = media_ops_.find( ev->req_id );
+
+    if( it == media_ops_.end() )
     {
-        if( ignore_non_response( ev ) )
-        {
-            return;
-        }
+        dummy_log_error( MODULENAME, "state %s, unexpected job_id: %u, msg %s, ignoring",
+                StrHelper::to_string( state_ ).c_str(),
+                ev->req_id,
+                typeid( *ev ).name() );
+        return;
+    }
+
+    auto req_id = it->first;
+    auto op     = it->second;
+
+    media_ops_.erase( it );
+
+    if( typeid( *ev ) == typeid( skype_service::ErrorEvent ) )
+    {
+        auto e = dynamic_cast<const skype_service::ErrorEvent*>( ev );
 
-        player_.on_play_file_response( ev->req_id );
+        dummy_log_error( MODULENAME, "job_id %u, error %u '%s'", req_id, e->error_code, e->descr.c_str() );
+
+        // the player answers its requests itself; a stop may have been answered already
+        // by the end of the playback, then the client must not get a second response
+        if( op == media_op_e::PLAY_STOP && player_.get_state() != PlayerSM::CANCELED_IN_P )
+            dummy_log_warn( MODULENAME, "job_id %u: stop already answered, error ignored", req_id );
+        else if( op == media_op_e::PLAY || op == media_op_e::PLAY_STOP )
+            player_.on_error_response( req_id, e->error_code, e->descr );
+        else
+            CALLBACK_SEND( dispatcher_, pool_.create_error_response( req_id, e->error_code, e->descr ) );
+
+        return;
     }
-    else if( typeid( *ev ) == typeid( skype_service::ErrorEvent ) )
+
+    switch( op )
     {
-        if( ignore_non_response( ev ) )
-        {
-            return;
-        }
+    case media_op_e::PLAY:
+        ASSERT( typeid( *ev ) == typeid( skype_service::AlterCallSetInputFileEvent ) );
+        player_.on_play_file_response( req_id );
+        break;
+
+    case media_op_e::PLAY_STOP:
+        // stop response is sent by the player on the end of the playback
+        ASSERT( typeid( *ev ) == typeid( skype_service::AlterCallSetInputFileEvent ) );
+        break;
 
-        player_.on_error_response( ev->req_id );
+    case media_op_e::RECORD:
+        ASSERT( typeid( *ev ) == typeid( skype_service::AlterCallSetOutputFileEvent ) );
+        CALLBACK_SEND( dispatcher_, pool_.create_record_file_response( req_id ) );
+        break;
+
+    default:
+        ASSERT( 0 );
+        break;
     }
 }
 
@@ -886,7 +1274,39 @@ void Dialer::start()
 {
     dummy_log_debug( MODULENAME, "start()" );
 
+    start_time_ = std::chrono::steady_clock::now();
+
     WorkerBase::start();
+
+    ticker_ = std::thread( & Dialer::ticker_thread, this );
+
+    // the responses arrive as ConnStatusEvent and UserStatusEvent
+    if( sio_->get_conn_status() == false )
+        dummy_log_error( MODULENAME, "start: failed to query connection status" );
+
+    if( sio_->get_user_status() == false )
+        dummy_log_error( MODULENAME, "start: failed to query user status" );
+
+    // done while waiting for the responses
+    warm_up();
+}
+
+void Dialer::warm_up()
+{
+    pool_.prefill();
+
+    dummy_log_debug( MODULENAME, "warm_up: done in %u us", (unsigned) std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start_time_ ).count() );
+}
+
+std::shared_future<void> Dialer::get_ready_future() const
+{
+    return ready_future_;
+}
+
+std::chrono::milliseconds Dialer::get_startup_time() const
+{
+    return std::chrono::milliseconds( startup_time_ms_.load() );
 }
 
 bool Dialer::shutdown()
@@ -898,50 +1318,151 @@ bool Dialer::shutdown()
     if( !is_inited__() )
         return false;
 
+    must_stop_ticker_   = true;
+
+    if( ticker_.joinable() )
+        ticker_.join();
+
     WorkerBase::shutdown();
 
+    // delivers the callbacks still queued
+    dispatcher_.clear();
+
     return true;
 }
 
-void Dialer::handle( const skype_service::ConnStatusEvent * e )
+void Dialer::ticker_thread()
 {
-    dummy_log_info( MODULENAME, "conn status %u", e->status );
+    dummy_log_debug( MODULENAME, "ticker_thread: started, tick %u ms", config_.timer_tick_ms );
 
-    cs_ = e->status;
+    while( must_stop_ticker_ == false )
+    {
+        std::this_thread::sleep_for( std::chrono::milliseconds( config_.timer_tick_ms ) );
 
-    switch_to_ready_if_possible();
+        // do not flood the queue if the worker is busy, one tick catches up all
+        if( is_tick_pending_.exchange( true ) == false )
+        {
+            WorkerBase::consume( new TimerTick );
+        }
+    }
+
+    dummy_log_debug( MODULENAME, "ticker_thread: exit" );
 }
 
-void Dialer::handle( const skype_service::UserStatusEvent * e )
+void Dialer::handle( const TimerTick * )
 {
-    dummy_log_info( MODULENAME, "user status %u", e->status );
+    // private: no mutex lock
 
-    us_ = e->status;
+    is_tick_pending_    = false;
+
+    timers_.advance( std::chrono::steady_clock::now() );
+}
+
+void Dialer::handle( const skype_service::ConnStatusEvent * e )
+{
+    dummy_log_info( MODULENAME, "conn status %u", e->status );
+
+    cs_ = e->status;
+
+    switch_to_ready_if_possible();
+}
+
+void Dialer::handle( const skype_service::UserStatusEvent * e )
+{
+    dummy_log_info( MODULENAME, "user status %u", e->status );
+
+    us_ = e->status;
 
     switch_to_ready_if_possible();
 }
 
+void Dialer::set_dnc_list( const std::shared_ptr<const DncList> & list )
+{
+    std::atomic_store( & dnc_list_, list );
+
+    dnc_list_version_.fetch_add( 1, std::memory_order_release );
+
+    dummy_log_info( MODULENAME, "set_dnc_list: %llu number(s)", list ? (unsigned long long) list->get_size() : 0ull );
+}
+
+bool Dialer::is_do_not_call( const PhoneNumber & number )
+{
+    // private: no mutex lock
+
+    // the shared pointer is only reloaded after a change, the old list is unmapped
+    // as soon as the worker drops it
+    uint32_t version = dnc_list_version_.load( std::memory_order_acquire );
+
+    if( version != dnc_list_cached_version_ )
+    {
+        dnc_list_cached_            = std::atomic_load( & dnc_list_ );
+        dnc_list_cached_version_    = version;
+    }
+
+    return dnc_list_cached_ && dnc_list_cached_->contains( number );
+}
+
+void Dialer::set_dial_plan( const std::shared_ptr<const DialPlan> & plan )
+{
+    std::atomic_store( & dial_plan_, plan );
+
+    dial_plan_version_.fetch_add( 1, std::memory_order_release );
+
+    dummy_log_info( MODULENAME, "set_dial_plan: %u route(s)", plan ? plan->get_num_routes() : 0 );
+}
+
+bool Dialer::route_party( const std::string & party, const PhoneNumber & number, std::string * outp )
+{
+    // private: no mutex lock
+
+    uint32_t version = dial_plan_version_.load( std::memory_order_acquire );
+
+    if( version != dial_plan_cached_version_ )
+    {
+        dial_plan_cached_           = std::atomic_load( & dial_plan_ );
+        dial_plan_cached_version_   = version;
+    }
+
+    // symbolic parties are not routed
+    if( dial_plan_cached_ == nullptr || number.is_valid() == false )
+        return transform_party( party, * outp );
+
+    auto route = dial_plan_cached_->find( number );
+
+    if( route == nullptr )
+        return false;
+
+    * outp = DialPlan::apply( * route, number );
+
+    return true;
+}
+
+bool Dialer::is_online() const
+{
+    return cs_ == skype_service::conn_status_e::ONLINE  &&
+            ( us_ == skype_service::user_status_e::ONLINE
+                    || us_ == skype_service::user_status_e::AWAY
+                    || us_ == skype_service::user_status_e::DND
+                    || us_ == skype_service::user_status_e::INVISIBLE
+                    || us_ == skype_service::user_status_e::NA );
+}
+
 void Dialer::switch_to_ready_if_possible()
 {
     if( state_ == UNKNOWN )
     {
-        if( cs_ == skype_service::conn_status_e::ONLINE  &&
-                ( us_ == skype_service::user_status_e::ONLINE
-                        || us_ == skype_service::user_status_e::AWAY
-                        || us_ == skype_service::user_status_e::DND
-                        || us_ == skype_service::user_status_e::INVISIBLE
-                        || us_ == skype_service::user_status_e::NA ) )
+        if( is_online() )
         {
             state_ = IDLE;
 
             dummy_log_info( MODULENAME, "switched to %s", StrHelper::to_string( state_ ).c_str() );
+
+            signal_ready();
         }
     }
     else if( state_ == IDLE )
     {
-        if( cs_ == skype_service::conn_status_e::OFFLINE
-                || cs_ == skype_service::conn_status_e::CONNECTING
-                || us_ == skype_service::user_status_e::OFFLINE )
+        if( is_online() == false )
         {
             state_ = UNKNOWN;
 
@@ -950,23 +1471,458 @@ void Dialer::switch_to_ready_if_possible()
     }
 }
 
+void Dialer::signal_ready()
+{
+    // private: no mutex lock
+
+    if( is_ready_signalled_ )
+        return;
+
+    is_ready_signalled_ = true;
+
+    auto t = std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::steady_clock::now() - start_time_ );
+
+    startup_time_ms_    = t.count();
+
+    dummy_log_info( MODULENAME, "ready, startup time %u ms", startup_time_ms_.load() );
+
+    ready_promise_.set_value();
+}
+
 void Dialer::switch_to_idle_and_cleanup()
 {
+    if( watchdog_id_ )
+    {
+        timers_.cancel( watchdog_id_ );
+        watchdog_id_    = 0;
+    }
+
+    // queued requests of the call would be dispatched to the next one
+    reject_pending_requests_of_call( call_id_ );
+
     state_          = IDLE;
     call_id_        = 0;
     current_job_id_ = 0;
 
+    // the call may end without a result set by the caller
+    if( outcome_req_id_ != 0 )
+        finish_outcome( is_call_connected_ ? call_result_e::COMPLETED : call_result_e::FAILED );
+
     pstn_status_    = 0;
     pstn_status_msg_.clear();
+    failure_reason_ = failure_reason_e::NONE;
+    is_call_connected_  = false;
+
+    cancel_voicemail_prompt();
+
+    voicemail_time_         = std::chrono::steady_clock::time_point();
+    voicemail_duration_     = 0;
 
-    failure_reason_ = 0;
-    failure_reason_msg_.clear();
+    if( media_ops_.empty() == false )
+    {
+        dummy_log_info( MODULENAME, "discarding %u outstanding media requests", (unsigned) media_ops_.size() );
+
+        media_ops_.clear();
+    }
 
     player_.on_loss();
 
     dummy_log_info( MODULENAME, "switched to %s", StrHelper::to_string( state_ ).c_str() );
 }
 
+void Dialer::send_outcome( uint32_t req_id, call_result_e result )
+{
+    if( outcome_callbacks_.empty() )
+        return;
+
+    CallOutcome o;
+
+    o.req_id            = req_id;
+    o.call_id           = 0;
+    o.result            = result;
+    o.failure_reason    = failure_reason_e::NONE;
+    o.pstn_status       = 0;
+    o.post_dial_ms      = 0;
+    o.ring_ms           = 0;
+    o.talk_ms           = 0;
+
+    for( auto c : outcome_callbacks_ )
+        c->on_call_outcome( o );
+}
+
+void Dialer::finish_outcome( call_result_e result )
+{
+    // private: called before cleanup, while the call data is still valid
+
+    if( outcome_req_id_ == 0 )
+        return;
+
+    CallOutcome o;
+
+    o.req_id            = outcome_req_id_;
+    o.call_id           = call_id_;
+    o.result            = result;
+    o.failure_reason    = failure_reason_;
+    o.pstn_status       = pstn_status_;
+
+    set_outcome_timing( & o );
+
+    outcome_req_id_     = 0;
+
+    dummy_log_debug( MODULENAME, "outcome: req id %u, call id %u, result %s, failure reason %s, PSTN %u",
+            o.req_id, o.call_id, StrHelper::to_string( o.result ).c_str(),
+            StrHelper::to_string( o.failure_reason ).c_str(), o.pstn_status );
+
+    for( auto c : outcome_callbacks_ )
+        c->on_call_outcome( o );
+}
+
+void Dialer::set_outcome_timing( CallOutcome * o ) const
+{
+    typedef std::chrono::steady_clock::time_point time_point;
+
+    auto to_ms = []( const time_point & from, const time_point & to )
+    {
+        return static_cast<uint32_t>( std::chrono::duration_cast<std::chrono::milliseconds>( to - from ).count() );
+    };
+
+    auto now            = std::chrono::steady_clock::now();
+
+    bool has_ringing    = ringing_time_ != time_point();
+    bool has_connected  = connected_time_ != time_point();
+
+    // a call may be connected without ringing, e.g. by an answering machine
+    auto first_progress = has_ringing ? ringing_time_ : ( has_connected ? connected_time_ : now );
+
+    o->post_dial_ms     = to_ms( dial_time_, first_progress );
+    o->ring_ms          = has_ringing ? to_ms( ringing_time_, has_connected ? connected_time_ : now ) : 0;
+    o->talk_ms          = has_connected ? to_ms( connected_time_, now ) : 0;
+}
+
+void Dialer::next_state( state_e state )
+{
+    state_  = state;
+
+    if( state == CONNECTED )
+    {
+        is_call_connected_  = true;
+        connected_time_     = std::chrono::steady_clock::now();
+    }
+
+    dummy_log_debug( MODULENAME, "switched to %s", StrHelper::to_string( state_ ).c_str() );
+
+    restart_watchdog();
+}
+
+void Dialer::restart_watchdog()
+{
+    if( watchdog_id_ )
+    {
+        timers_.cancel( watchdog_id_ );
+        watchdog_id_    = 0;
+    }
+
+    uint32_t timeout_ms = 0;
+
+    switch( state_ )
+    {
+    case WAITING_INITIATE_CALL_RESPONSE:
+        timeout_ms  = config_.call_setup_timeout_ms;
+        break;
+
+    case WAITING_CONNECTION:
+        timeout_ms  = config_.no_answer_timeout_ms;
+        break;
+
+    case CANCELED_IN_WC:
+    case CANCELED_IN_C:
+        timeout_ms  = config_.drop_timeout_ms;
+        break;
+
+    default:
+        break;
+    }
+
+    if( timeout_ms == 0 )
+        return;
+
+    auto state = state_;
+
+    watchdog_id_    = timers_.insert( timeout_ms, [this, state]() { on_watchdog( state ); } );
+}
+
+void Dialer::on_watchdog( state_e state )
+{
+    // private: no mutex lock
+
+    watchdog_id_    = 0;    // not valid after the timer has fired
+
+    if( state != state_ )
+    {
+        dummy_log_error( MODULENAME, "on_watchdog: stale watchdog of state %s in state %s, ignored",
+                StrHelper::to_string( state ).c_str(), StrHelper::to_string( state_ ).c_str() );
+        return;
+    }
+
+    dummy_log_warn( MODULENAME, "on_watchdog: timeout in state %s, call id %u, job_id %u",
+            StrHelper::to_string( state_ ).c_str(), call_id_, current_job_id_ );
+
+    switch( state_ )
+    {
+    case WAITING_INITIATE_CALL_RESPONSE:
+    {
+        stats_.inc( counter_e::CALL_SETUP_TIMEOUTS );
+
+        // the call may still be placed, it will be hung up as soon as its id is known
+        forget_later( & abandoned_job_ids_, current_job_id_ );
+
+        send_error_response( current_job_id_, ERROR_CODE_CALL_SETUP_TIMEOUT, "call setup timeout" );
+        finish_outcome( call_result_e::SETUP_ERROR );
+    }
+        break;
+
+    case WAITING_CONNECTION:
+    {
+        stats_.inc( counter_e::NO_ANSWER_TIMEOUTS );
+
+        abandon_call( call_id_ );
+
+        CALLBACK_SEND( dispatcher_, pool_.create_failed( call_id_, simple_voip::Failed::FAILED, "no answer" ) );
+        finish_outcome( call_result_e::NO_ANSWER );
+    }
+        break;
+
+    case CANCELED_IN_WC:
+    case CANCELED_IN_C:
+    {
+        stats_.inc( state_ == CANCELED_IN_WC ? counter_e::DROP_TIMEOUTS_IN_WC : counter_e::DROP_TIMEOUTS_IN_C );
+
+        abandon_call( call_id_ );
+
+        send_error_response( current_job_id_, ERROR_CODE_DROP_TIMEOUT, "drop timeout" );
+
+        // same end of call as the other paths: a connected call is lost, not failed
+        if( is_call_connected_ )
+            CALLBACK_SEND( dispatcher_, pool_.create_connection_lost( call_id_, "drop timeout" ) );
+        else
+            CALLBACK_SEND( dispatcher_, pool_.create_failed( call_id_, simple_voip::Failed::FAILED, "drop timeout" ) );
+        finish_outcome( is_call_connected_ ? call_result_e::COMPLETED : call_result_e::CANCELED );
+    }
+        break;
+
+    default:
+        ASSERT( 0 );
+        break;
+    }
+
+    switch_to_idle_and_cleanup();
+}
+
+void Dialer::abandon_call( uint32_t call_id )
+{
+    forget_later( & abandoned_call_ids_, call_id );
+
+    uint32_t job_id = next_hangup_job_id();
+
+    bool b = sio_->set_call_status( call_id, skype_service::call_status_e::FINISHED, job_id );
+
+    if( b == false )
+    {
+        dummy_log_error( MODULENAME, "abandon_call: failed to hang up call %u", call_id );
+        return;
+    }
+
+    forget_later( & hangup_job_ids_, job_id );
+
+    dummy_log_info( MODULENAME, "abandon_call: hanging up call %u, job_id %u", call_id, job_id );
+}
+
+void Dialer::forget_later( std::set<uint32_t> * ids, uint32_t id )
+{
+    // private: no mutex lock
+
+    ids->insert( id );
+
+    // the reply that removes the id may never come, e.g. if it was lost or the request failed
+    timers_.insert( ABANDONED_TTL_MS, [ids, id]() { ids->erase( id ); } );
+}
+
+uint32_t Dialer::next_hangup_job_id()
+{
+    if( ++last_hangup_job_id_ == 0 )
+        last_hangup_job_id_ = HANGUP_JOB_ID_BASE;
+
+    return last_hangup_job_id_;
+}
+
+bool Dialer::play_voicemail_prompt()
+{
+    // private: no mutex lock
+
+    // a playback of the client is not interrupted by the prompt
+    if( config_.voicemail_prompt.empty() || player_.get_state() != PlayerSM::IDLE )
+        return false;
+
+    uint32_t job_id = next_hangup_job_id();
+
+    bool b = sio_->alter_call_set_input_file( call_id_, config_.voicemail_prompt, job_id );
+
+    if( b == false )
+    {
+        dummy_log_error( MODULENAME, "failed playing voicemail prompt: %s", config_.voicemail_prompt.c_str() );
+        return false;
+    }
+
+    forget_later( & hangup_job_ids_, job_id );
+
+    is_voicemail_prompt_    = true;
+
+    auto call_id = call_id_;
+
+    voicemail_timer_id_     = timers_.insert( config_.voicemail_prompt_ms, [this, call_id]() { on_voicemail_prompt_end( call_id ); } );
+
+    dummy_log_debug( MODULENAME, "call %u: playing voicemail prompt %s", call_id_, config_.voicemail_prompt.c_str() );
+
+    return true;
+}
+
+void Dialer::on_voicemail_prompt_end( uint32_t call_id )
+{
+    // private: no mutex lock
+
+    voicemail_timer_id_ = 0;    // not valid after the timer has fired
+
+    if( state_ != CONNECTED || call_id != call_id_ || is_voicemail_prompt_ == false )
+        return;
+
+    dummy_log_debug( MODULENAME, "call %u: voicemail prompt timeout", call_id );
+
+    drop_voicemail();
+}
+
+void Dialer::cancel_voicemail_prompt()
+{
+    // private: no mutex lock
+
+    if( voicemail_timer_id_ )
+    {
+        timers_.cancel( voicemail_timer_id_ );
+        voicemail_timer_id_ = 0;
+    }
+
+    is_voicemail_prompt_    = false;
+}
+
+void Dialer::drop_voicemail()
+{
+    // private: no mutex lock
+
+    // a drop requested by the client is already pending in the other states
+    ASSERT( state_ == CONNECTED );
+
+    // the line would stay busy for the voicemail, the time of the prompt is not reclaimed
+    auto held_ms = std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::steady_clock::now() - voicemail_time_ ).count();
+
+    if( voicemail_duration_ * 1000ll > held_ms )
+        stats_.inc( counter_e::VOICEMAIL_RECLAIMED_SEC, static_cast<uint32_t>( ( voicemail_duration_ * 1000ll - held_ms ) / 1000 ) );
+
+    stats_.inc( counter_e::VOICEMAIL_DROPS );
+
+    auto call_id = call_id_;
+
+    dummy_log_info( MODULENAME, "call %u: dropping voicemail", call_id );
+
+    abandon_call( call_id );
+
+    CALLBACK_SEND( dispatcher_, pool_.create_connection_lost( call_id, "voicemail" ) );
+    finish_outcome( call_result_e::VOICEMAIL );
+
+    switch_to_idle_and_cleanup();
+}
+
+bool Dialer::ignore_abandoned_call( const skype_service::Event * ev )
+{
+    // private: no mutex lock
+
+    if( ev->req_id != 0 && hangup_job_ids_.erase( ev->req_id ) > 0 )
+    {
+        dummy_log_debug( MODULENAME, "ignoring response %s to hang up job_id %u", typeid( *ev ).name(), ev->req_id );
+        return true;
+    }
+
+    if( ev->req_id != 0 && abandoned_job_ids_.count( ev->req_id ) > 0 )
+    {
+        abandoned_job_ids_.erase( ev->req_id );
+
+        if( typeid( *ev ) == typeid( skype_service::CallStatusEvent ) )
+        {
+            auto call_id = dynamic_cast<const skype_service::CallStatusEvent*>( ev )->call_id;
+
+            dummy_log_warn( MODULENAME, "late response to abandoned job_id %u, call id %u", ev->req_id, call_id );
+
+            abandon_call( call_id );
+        }
+        else
+        {
+            dummy_log_info( MODULENAME, "late response %s to abandoned job_id %u, ignored", typeid( *ev ).name(), ev->req_id );
+        }
+
+        return true;
+    }
+
+    uint32_t call_id;
+
+    if( get_call_id( ev, & call_id ) == false || abandoned_call_ids_.count( call_id ) == 0 )
+        return false;
+
+    if( typeid( *ev ) == typeid( skype_service::CallStatusEvent ) )
+    {
+        auto s = dynamic_cast<const skype_service::CallStatusEvent*>( ev )->status;
+
+        switch( s )
+        {
+        case skype_service::call_status_e::FINISHED:
+        case skype_service::call_status_e::CANCELLED:
+        case skype_service::call_status_e::FAILED:
+        case skype_service::call_status_e::MISSED:
+        case skype_service::call_status_e::REFUSED:
+        case skype_service::call_status_e::BUSY:
+        case skype_service::call_status_e::VM_FAILED:
+        case skype_service::call_status_e::VM_SENT:
+            dummy_log_info( MODULENAME, "abandoned call %u ended", call_id );
+            abandoned_call_ids_.erase( call_id );
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    dummy_log_debug( MODULENAME, "ignoring event %s of abandoned call %u", typeid( *ev ).name(), call_id );
+
+    return true;
+}
+
+bool Dialer::get_call_id( const skype_service::Event * ev, uint32_t * call_id )
+{
+    if( typeid( *ev ) == typeid( skype_service::CallStatusEvent ) )
+        * call_id   = dynamic_cast<const skype_service::CallStatusEvent*>( ev )->call_id;
+    else if( typeid( *ev ) == typeid( skype_service::CallPstnStatusEvent ) )
+        * call_id   = dynamic_cast<const skype_service::CallPstnStatusEvent*>( ev )->call_id;
+    else if( typeid( *ev ) == typeid( skype_service::CallFailureReasonEvent ) )
+        * call_id   = dynamic_cast<const skype_service::CallFailureReasonEvent*>( ev )->call_id;
+    else if( typeid( *ev ) == typeid( skype_service::CallDurationEvent ) )
+        * call_id   = dynamic_cast<const skype_service::CallDurationEvent*>( ev )->call_id;
+    else if( typeid( *ev ) == typeid( skype_service::VoicemailDurationEvent ) )
+        * call_id   = dynamic_cast<const skype_service::VoicemailDurationEvent*>( ev )->call_id;
+    else if( typeid( *ev ) == typeid( skype_service::CallVaaInputStatusEvent ) )
+        * call_id   = dynamic_cast<const skype_service::CallVaaInputStatusEvent*>( ev )->call_id;
+    else
+        return false;
+
+    return true;
+}
+
 void Dialer::handle( const skype_service::CurrentUserHandleEvent * e )
 {
     dummy_log_info( MODULENAME, "current user handle %s", e->user_handle.c_str() );
@@ -979,7 +1935,7 @@ void Dialer::handle( const skype_service::ErrorEvent * e )
 {
     dummy_log_error( MODULENAME, "unhandled error %u '%s'", e->error_code, e->descr.c_str() );
 
-    callback_consume( simple_voip::create_error_response( 0, e->error_code, e->descr ) );
+    CALLBACK_SEND( dispatcher_, pool_.create_error_response( 0, e->error_code, e->descr ) );
 }
 
 void Dialer::handle_in_w_ical( const skype_service::CallStatusEvent * e )
@@ -996,13 +1952,23 @@ void Dialer::handle_in_w_ical( const skype_service::CallStatusEvent * e )
 
     dummy_log_debug( MODULENAME, "job_id %u, call initiated: %u, status %s", current_job_id_, call_id, skype_service::to_string( s ).c_str() );
 
-    callback_consume( simple_voip::create_initiate_call_response( current_job_id_, call_id ) );
+    if( max_call_id_ != 0 && call_id > max_call_id_ )
+    {
+        dummy_log_error( MODULENAME, "job_id %u: call id %u exceeds %u, hanging up", current_job_id_, call_id, max_call_id_ );
+
+        abandon_call( call_id );
+
+        send_error_response( current_job_id_, ERROR_CODE_CALL_ID_OUT_OF_RANGE, "call id out of range" );
+        finish_outcome( call_result_e::SETUP_ERROR );
+        switch_to_idle_and_cleanup();
+        return;
+    }
+
+    CALLBACK_SEND( dispatcher_, pool_.create_initiate_call_response( current_job_id_, call_id ) );
 
     current_job_id_ = 0;
     call_id_        = call_id;
-    state_          = WAITING_CONNECTION;
-
-    dummy_log_debug( MODULENAME, "switched to %s", StrHelper::to_string( state_ ).c_str() );
+    next_state( WAITING_CONNECTION );
 }
 
 void Dialer::handle_in_w_conn( const skype_service::CallStatusEvent * e )
@@ -1015,76 +1981,84 @@ void Dialer::handle_in_w_conn( const skype_service::CallStatusEvent * e )
     switch( s )
     {
     case skype_service::call_status_e::CANCELLED:
-        callback_consume( simple_voip::create_failed( call_id, simple_voip::Failed::FAILED, "cancelled by user" ) );
+        CALLBACK_SEND( dispatcher_, pool_.create_failed( call_id, simple_voip::Failed::FAILED, "cancelled by user" ) );
+        finish_outcome( call_result_e::FAILED );
         switch_to_idle_and_cleanup();
         break;
 
     case skype_service::call_status_e::FINISHED:
         if( pstn_status_ != 0 )
-            callback_consume( simple_voip::create_failed( call_id, simple_voip::Failed::FAILED, "PSTN: " + std::to_string( pstn_status_ ) + ", " + pstn_status_msg_ ) );
+            CALLBACK_SEND( dispatcher_, pool_.create_failed( call_id, simple_voip::Failed::FAILED, "PSTN: " + std::to_string( pstn_status_ ) + ", " + get_pstn_status_descr() ) );
         else
-            callback_consume( simple_voip::create_failed( call_id, simple_voip::Failed::FAILED, "cancelled by user" ) );
+            CALLBACK_SEND( dispatcher_, pool_.create_failed( call_id, simple_voip::Failed::FAILED, "cancelled by user" ) );
+
+        finish_outcome( call_result_e::FAILED );
 
         switch_to_idle_and_cleanup();
         break;
 
     case skype_service::call_status_e::ROUTING:
-        callback_consume( simple_voip::create_message_t<simple_voip::Dialing>( call_id ) );
+        CALLBACK_SEND( dispatcher_, pool_.create_message_t<simple_voip::Dialing>( call_id ) );
         break;
 
     case skype_service::call_status_e::RINGING:
-        callback_consume( simple_voip::create_message_t<simple_voip::Ringing>( call_id ) );
+        if( ringing_time_ == std::chrono::steady_clock::time_point() )
+            ringing_time_   = std::chrono::steady_clock::now();
+
+        CALLBACK_SEND( dispatcher_, pool_.create_message_t<simple_voip::Ringing>( call_id ) );
         break;
 
     case skype_service::call_status_e::VM_RECORDING:
-        callback_consume( simple_voip::create_message_t<simple_voip::Connected>( call_id ) );
-        state_          = CONNECTED;
-        dummy_log_debug( MODULENAME, "switched to %s", StrHelper::to_string( state_ ).c_str() );
+        CALLBACK_SEND( dispatcher_, pool_.create_message_t<simple_voip::Connected>( call_id ) );
+        next_state( CONNECTED );
         break;
 
     case skype_service::call_status_e::INPROGRESS:
-        callback_consume( simple_voip::create_message_t<simple_voip::Connected>( call_id ) );
-        state_          = CONNECTED;
-
-        dummy_log_debug( MODULENAME, "switched to %s", StrHelper::to_string( state_ ).c_str() );
+        CALLBACK_SEND( dispatcher_, pool_.create_message_t<simple_voip::Connected>( call_id ) );
+        next_state( CONNECTED );
 
-        if( data_port_ != 0 )
+        if( config_.data_port != 0 )
         {
-            dummy_log_debug( MODULENAME, "redirected input data to port %u", data_port_ );
+            dummy_log_debug( MODULENAME, "redirected input data to port %u", config_.data_port );
 
-            bool b = sio_->alter_call_set_output_port( call_id, data_port_ );
+            bool b = sio_->alter_call_set_output_port( call_id, config_.data_port );
 
             if( b == false )
             {
-                dummy_log_error( MODULENAME, "failed to redirect input data to port %u", data_port_ );
+                dummy_log_error( MODULENAME, "failed to redirect input data to port %u", config_.data_port );
             }
         }
 
         break;
 
     case skype_service::call_status_e::NONE:
-        callback_consume( simple_voip::create_failed( call_id, simple_voip::Failed::FAILED, "call ended unexpectedly" ) );
+        CALLBACK_SEND( dispatcher_, pool_.create_failed( call_id, simple_voip::Failed::FAILED, "call ended unexpectedly" ) );
+        finish_outcome( call_result_e::FAILED );
         switch_to_idle_and_cleanup();
         break;
 
     case skype_service::call_status_e::FAILED:
     case skype_service::call_status_e::VM_FAILED:
-        callback_consume( simple_voip::create_failed( call_id, simple_voip::Failed::FAILED, "call failed" ) );
+        CALLBACK_SEND( dispatcher_, pool_.create_failed( call_id, simple_voip::Failed::FAILED, "call failed" ) );
+        finish_outcome( call_result_e::FAILED );
         switch_to_idle_and_cleanup();
         break;
 
     case skype_service::call_status_e::MISSED:
-        callback_consume( simple_voip::create_failed( call_id, simple_voip::Failed::REFUSED, "call was missed" ) );
+        CALLBACK_SEND( dispatcher_, pool_.create_failed( call_id, simple_voip::Failed::REFUSED, "call was missed" ) );
+        finish_outcome( call_result_e::NO_ANSWER );
         switch_to_idle_and_cleanup();
         break;
 
     case skype_service::call_status_e::BUSY:
-        callback_consume( simple_voip::create_failed( call_id, simple_voip::Failed::BUSY, "number is busy" ) );
+        CALLBACK_SEND( dispatcher_, pool_.create_failed( call_id, simple_voip::Failed::BUSY, "number is busy" ) );
+        finish_outcome( call_result_e::BUSY );
         switch_to_idle_and_cleanup();
 
         break;
     case skype_service::call_status_e::REFUSED:
-        callback_consume( simple_voip::create_failed( call_id, simple_voip::Failed::REFUSED, "call was refused" ) );
+        CALLBACK_SEND( dispatcher_, pool_.create_failed( call_id, simple_voip::Failed::REFUSED, "call was refused" ) );
+        finish_outcome( call_result_e::REFUSED );
         switch_to_idle_and_cleanup();
         break;
 
@@ -1104,15 +2078,18 @@ void Dialer::handle_in_connected( const skype_service::CallStatusEvent * e )
     switch( s )
     {
     case skype_service::call_status_e::CANCELLED:
-        callback_consume( simple_voip::create_connection_lost( call_id, "cancelled by user" ) );
+        CALLBACK_SEND( dispatcher_, pool_.create_connection_lost( call_id, "cancelled by user" ) );
+        finish_outcome( call_result_e::COMPLETED );
         switch_to_idle_and_cleanup();
         break;
 
     case skype_service::call_status_e::FINISHED:
         if( pstn_status_ != 0 )
-            callback_consume( simple_voip::create_connection_lost( call_id, "PSTN: " + std::to_string( pstn_status_ ) + ", " + pstn_status_msg_ ) );
+            CALLBACK_SEND( dispatcher_, pool_.create_connection_lost( call_id, "PSTN: " + std::to_string( pstn_status_ ) + ", " + get_pstn_status_descr() ) );
         else
-            callback_consume( simple_voip::create_connection_lost( call_id, "cancelled by user" ) );
+            CALLBACK_SEND( dispatcher_, pool_.create_connection_lost( call_id, "cancelled by user" ) );
+
+        finish_outcome( call_result_e::COMPLETED );
 
         switch_to_idle_and_cleanup();
         break;
@@ -1131,12 +2108,14 @@ void Dialer::handle_in_connected( const skype_service::CallStatusEvent * e )
         break;
 
     case skype_service::call_status_e::NONE:
-        callback_consume( simple_voip::create_connection_lost( call_id, "call ended unexpectedly" ) );
+        CALLBACK_SEND( dispatcher_, pool_.create_connection_lost( call_id, "call ended unexpectedly" ) );
+        finish_outcome( call_result_e::CONNECTION_LOST );
         switch_to_idle_and_cleanup();
         break;
 
     case skype_service::call_status_e::FAILED:
-        callback_consume( simple_voip::create_connection_lost( call_id, "call failed" ) );
+        CALLBACK_SEND( dispatcher_, pool_.create_connection_lost( call_id, "call failed" ) );
+        finish_outcome( call_result_e::CONNECTION_LOST );
         switch_to_idle_and_cleanup();
         break;
 
@@ -1164,7 +2143,8 @@ void Dialer::handle_in_w_drpr( const skype_service::CallStatusEvent * e )
 
     case skype_service::call_status_e::FINISHED:
     {
-        callback_consume( simple_voip::create_drop_response( current_job_id_ ) );
+        CALLBACK_SEND( dispatcher_, pool_.create_drop_response( current_job_id_ ) );
+        finish_outcome( call_result_e::COMPLETED );
 
         switch_to_idle_and_cleanup();
     }
@@ -1172,7 +2152,8 @@ void Dialer::handle_in_w_drpr( const skype_service::CallStatusEvent * e )
 
 
     case skype_service::call_status_e::VM_SENT:
-        callback_consume( simple_voip::create_drop_response( current_job_id_ ) );
+        CALLBACK_SEND( dispatcher_, pool_.create_drop_response( current_job_id_ ) );
+        finish_outcome( call_result_e::COMPLETED );
 
         switch_to_idle_and_cleanup();
         break;
@@ -1226,7 +2207,8 @@ void Dialer::handle_in_w_drpr_2( const skype_service::CallStatusEvent * e )
         }
         */
 
-        callback_consume( simple_voip::create_drop_response( current_job_id_ ) );
+        CALLBACK_SEND( dispatcher_, pool_.create_drop_response( current_job_id_ ) );
+        finish_outcome( call_result_e::CANCELED );
 
         switch_to_idle_and_cleanup();
 
@@ -1282,6 +2264,15 @@ void Dialer::handle( const skype_service::CallPstnStatusEvent * ev )
     pstn_status_msg_    = ev->descr;
 }
 
+std::string Dialer::get_pstn_status_descr() const
+{
+    // the text of the service is more precise, the table is the fallback if it sent none
+    if( pstn_status_msg_.empty() == false )
+        return pstn_status_msg_;
+
+    return get_pstn_status_text( pstn_status_ );
+}
+
 void Dialer::handle( const skype_service::CallDurationEvent * e )
 {
     dummy_log_debug( MODULENAME, "call %u dur %u", e->call_id, e->duration );
@@ -1290,17 +2281,31 @@ void Dialer::handle( const skype_service::CallDurationEvent * e )
 void Dialer::handle( const skype_service::VoicemailDurationEvent * e )
 {
     dummy_log_debug( MODULENAME, "call %u voicemail dur %u", e->call_id, e->duration );
+
+    // only the first event of the call counts
+    if( config_.voicemail_policy == voicemail_policy_e::NONE || voicemail_time_ != std::chrono::steady_clock::time_point() )
+        return;
+
+    dummy_log_info( MODULENAME, "call %u: voicemail detected", e->call_id );
+
+    stats_.inc( counter_e::VOICEMAIL_DETECTED );
+
+    voicemail_time_     = std::chrono::steady_clock::now();
+    voicemail_duration_ = e->duration;
+
+    if( config_.voicemail_policy == voicemail_policy_e::PLAY_AND_DROP && play_voicemail_prompt() )
+        return;
+
+    drop_voicemail();
 }
 
 void Dialer::handle( const skype_service::CallFailureReasonEvent * e )
 {
-    dummy_log_info( MODULENAME, "call %u failure %u", e->call_id, e->reason );
+    dummy_log_info( MODULENAME, "call %u failure %u (%s)", e->call_id, e->reason, StrHelper::to_string( decode_failure_reason( e->reason ) ).c_str() );
 
-    ASSERT( failure_reason_ == 0 );
-    ASSERT( failure_reason_msg_.empty() );
+    ASSERT( failure_reason_ == failure_reason_e::NONE );
 
-    failure_reason_     = e->reason;
-    failure_reason_msg_ = decode_failure_reason( failure_reason_ );
+    failure_reason_     = decode_failure_reason( e->reason );
 }
 
 void Dialer::handle( const DetectedTone * e )
@@ -1313,9 +2318,7 @@ void Dialer::handle( const DetectedTone * e )
     {
         auto tone = decode_tone( e->tone );
 
-        auto ev = simple_voip::create_dtmf_tone( call_id_, tone );
-
-        callback_consume( ev );
+        CALLBACK_SEND( dispatcher_, pool_.create_dtmf_tone( call_id_, tone ) );
     }
         break;
     default:
@@ -1326,33 +2329,6 @@ void Dialer::handle( const DetectedTone * e )
 
 }
 
-const char* Dialer::decode_failure_reason( const uint32_t c )
-{
-    static const char* table[] =
-    {
-        "",
-        "Miscellaneous error",
-        "User or phone number does not exist. Check that a prefix is entered for the phone number, either in the form 003725555555 or +3725555555; the form 3725555555 is incorrect.",
-        "User is offline",
-        "No proxy found",
-        "Session terminated.",
-        "No common codec found.",
-        "Sound I/O error.",
-        "Problem with remote sound device.",
-        "Call blocked by recipient.",
-        "Recipient not a friend.",
-        "Current user not authorized by recipient.",
-        "Sound recording error.",
-        "Failure to call a commercial contact.",
-        "Conference call has been dropped by the host. Note that this does not normally indicate abnormal call termination. Call being dropped for all the participants when the conference host leavs the call is expected behaviour."
-    };
-
-    if( c > 14 )
-        return "";
-
-    return table[ c ];
-}
-
 simple_voip::DtmfTone::tone_e Dialer::decode_tone( dtmf::tone_e tone )
 {
     static const simple_voip::DtmfTone::tone_e table[] =
@@ -1383,33 +2359,164 @@ simple_voip::DtmfTone::tone_e Dialer::decode_tone( dtmf::tone_e tone )
     return simple_voip::DtmfTone::tone_e::TONE_A;
 }
 
-Dialer::party_e Dialer::get_party_type( const std::string & inp )
+uint32_t Dialer::get_req_id( const simple_voip::ForwardObject * req )
 {
-    if( regex_match( inp, "^\\+[1-9]+[0-9]*$") )
-        return party_e::NUMBER;
-    if ( regex_match( inp, "^[a-zA-Z][a-zA-Z0-9_]*$") )
-        return party_e::SYMBOLIC;
+    if( typeid( *req ) == typeid( simple_voip::InitiateCallRequest ) )
+        return dynamic_cast< const simple_voip::InitiateCallRequest *>( req )->req_id;
+    if( typeid( *req ) == typeid( simple_voip::PlayFileRequest ) )
+        return dynamic_cast< const simple_voip::PlayFileRequest *>( req )->req_id;
+    if( typeid( *req ) == typeid( simple_voip::PlayFileStopRequest ) )
+        return dynamic_cast< const simple_voip::PlayFileStopRequest *>( req )->req_id;
+    if( typeid( *req ) == typeid( simple_voip::RecordFileRequest ) )
+        return dynamic_cast< const simple_voip::RecordFileRequest *>( req )->req_id;
+    if( typeid( *req ) == typeid( simple_voip::DropRequest ) )
+        return dynamic_cast< const simple_voip::DropRequest *>( req )->req_id;
+
+    return 0;
+}
 
-    return party_e::UNKNOWN;
+uint32_t Dialer::get_call_id( const simple_voip::ForwardObject * req )
+{
+    if( typeid( *req ) == typeid( simple_voip::PlayFileRequest ) )
+        return dynamic_cast< const simple_voip::PlayFileRequest *>( req )->call_id;
+    if( typeid( *req ) == typeid( simple_voip::PlayFileStopRequest ) )
+        return dynamic_cast< const simple_voip::PlayFileStopRequest *>( req )->call_id;
+    if( typeid( *req ) == typeid( simple_voip::RecordFileRequest ) )
+        return dynamic_cast< const simple_voip::RecordFileRequest *>( req )->call_id;
+    if( typeid( *req ) == typeid( simple_voip::DropRequest ) )
+        return dynamic_cast< const simple_voip::DropRequest *>( req )->call_id;
+
+    return 0;
 }
 
-bool Dialer::transform_party( const std::string & inp, std::string & outp )
+bool Dialer::is_expired( const std::chrono::steady_clock::time_point & deadline )
 {
-    auto party_type = get_party_type( inp );
+    if( deadline == std::chrono::steady_clock::time_point() )
+        return false;
+
+    return std::chrono::steady_clock::now() >= deadline;
+}
+
+void Dialer::send_expired_response( const simple_voip::ForwardObject * req )
+{
+    auto req_id = get_req_id( req );
+
+    dummy_log_warn( MODULENAME, "request %s, req id %u expired in queue, not processed", typeid( *req ).name(), req_id );
+
+    stats_.inc( counter_e::EXPIRED_REQUESTS );
+
+    send_error_response( req_id, ERROR_CODE_REQUEST_EXPIRED, "request expired" );
 
-    if( party_type == party_e::NUMBER )
+    if( typeid( *req ) == typeid( simple_voip::InitiateCallRequest ) )
+        send_outcome( req_id, call_result_e::REJECTED );
+}
+
+void Dialer::enqueue_pending_request( const SimpleVoipWrap * w )
+{
+    // private: no mutex lock
+
+    if( pending_requests_.size() >= config_.max_pending_requests )
     {
-        outp = "00" + inp.substr( 1 );
-        return true;
+        dummy_log_warn( MODULENAME, "pending request queue is full (%u)", config_.max_pending_requests );
+
+        auto req_id = get_req_id( w->obj );
+
+        if( send_reject_if_in_request_processing( req_id ) == false )
+            send_reject_response( req_id, 0, "too many pending requests" );
+
+        if( typeid( *w->obj ) == typeid( simple_voip::InitiateCallRequest ) )
+            send_outcome( req_id, call_result_e::REJECTED );
+
+        delete w->obj;
+        return;
     }
 
-    if( party_type == party_e::SYMBOLIC )
+    PendingRequest r = { w->obj, w->deadline };
+
+    pending_requests_.push_back( r );
+
+    stats_.inc( counter_e::QUEUED_REQUESTS );
+
+    dummy_log_debug( MODULENAME, "queued request %s, %u pending, currently processing request %u",
+            typeid( *w->obj ).name(), (unsigned) pending_requests_.size(), current_job_id_ );
+}
+
+void Dialer::process_pending_requests()
+{
+    // private: no mutex lock
+
+    // dispatch until a request occupies current_job_id_ again
+    while( current_job_id_ == 0 && pending_requests_.empty() == false )
     {
-        outp = inp;
-        return true;
+        PendingRequest r = pending_requests_.front();
+
+        pending_requests_.pop_front();
+
+        dummy_log_debug( MODULENAME, "dispatching queued request %s, %u pending", typeid( *r.obj ).name(), (unsigned) pending_requests_.size() );
+
+        auto call_id = get_call_id( r.obj );
+
+        if( call_id != 0 && is_call_id_valid( call_id ) == false )
+        {
+            send_reject_response( get_req_id( r.obj ), 0, "call " + std::to_string( call_id ) + " ended" );
+
+            delete r.obj;
+            continue;
+        }
+
+        handle( r.obj, r.deadline );
     }
+}
 
-    return false;
+void Dialer::reject_pending_requests( uint32_t errorcode, const std::string & descr )
+{
+    // private: no mutex lock
+
+    if( pending_requests_.empty() )
+        return;
+
+    dummy_log_info( MODULENAME, "rejecting %u pending request(s): %s", (unsigned) pending_requests_.size(), descr.c_str() );
+
+    for( auto & r : pending_requests_ )
+    {
+        auto req_id = get_req_id( r.obj );
+
+        send_reject_response( req_id, errorcode, descr );
+
+        if( typeid( *r.obj ) == typeid( simple_voip::InitiateCallRequest ) )
+            send_outcome( req_id, call_result_e::REJECTED );
+
+        delete r.obj;
+    }
+
+    pending_requests_.clear();
+}
+
+void Dialer::reject_pending_requests_of_call( uint32_t call_id )
+{
+    // private: no mutex lock
+
+    if( call_id == 0 )
+        return;
+
+    for( auto it = pending_requests_.begin(); it != pending_requests_.end(); )
+    {
+        if( get_call_id( it->obj ) != call_id )
+        {
+            ++it;
+            continue;
+        }
+
+        auto req_id = get_req_id( it->obj );
+
+        dummy_log_info( MODULENAME, "rejecting queued request %s, req id %u: call %u ended", typeid( *it->obj ).name(), req_id, call_id );
+
+        send_reject_response( req_id, 0, "call " + std::to_string( call_id ) + " ended" );
+
+        delete it->obj;
+
+        it = pending_requests_.erase( it );
+    }
 }
 
 bool Dialer::is_call_id_valid( uint32_t call_id ) const
@@ -1419,18 +2526,12 @@ bool Dialer::is_call_id_valid( uint32_t call_id ) const
 
 void Dialer::send_reject_response( uint32_t job_id, uint32_t errorcode, const std::string & descr )
 {
-    callback_consume( simple_voip::create_reject_response( job_id, errorcode, descr ) );
+    CALLBACK_SEND( dispatcher_, pool_.create_reject_response( job_id, errorcode, descr ) );
 }
 
 void Dialer::send_error_response( uint32_t job_id, uint32_t errorcode, const std::string & descr )
 {
-    callback_consume( simple_voip::create_error_response( job_id, errorcode, descr ) );
-}
-
-void Dialer::callback_consume( const simple_voip::CallbackObject * req )
-{
-    if( callback_ )
-        callback_->consume( req );
+    CALLBACK_SEND( dispatcher_, pool_.create_error_response( job_id, errorcode, descr ) );
 }
 
 void Dialer::send_reject_due_to_wrong_state( uint32_t job_id )
@@ -27,6 +27,15 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 #include <string>                   // std::string
 #include <mutex>                    // std::mutex
 #include <cstdint>                  // uint32_t
+#include <chrono>                   // std::chrono::steady_clock
+#include <deque>                    // std::deque
+#include <map>                      // std::map
+#include <set>                      // std::set
+#include <vector>                   // std::vector
+#include <thread>                   // std::thread
+#include <atomic>                   // std::atomic
+#include <future>                   // std::shared_future
+#include <memory>                   // std::shared_ptr
 
 #include "../simple_voip/i_simple_voip.h"       // ISimpleVoip
 #include "../simple_voip/i_simple_voip_callback.h" // ISimpleVoipCallback
@@ -38,6 +47,20 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 #include "../threcon/i_controllable.h"          // IControllable
 #include "../dtmf_detector/IDtmfDetectorCallback.hpp"   // IDtmfDetectorCallback
 #include "player_sm.h"                          // PlayerSM
+#include "config.h"                             // Config
+#include "stats.h"                              // Stats
+#include "timer_wheel.h"                        // TimerWheel
+#include "seqlock.h"                            // SeqLockT
+#include "async_callback.h"                     // AsyncCallback
+#include "callback_object_pool.h"               // CallbackObjectPool
+#include "callback_dispatcher.h"                // CallbackDispatcher
+#include "typed_callback_adapter.h"             // TypedCallbackAdapter
+#include "i_typed_callback.h"                   // ITypedCallback
+#include "call_outcome.h"                       // CallOutcome, IOutcomeCallback
+#include "failure_reason.h"                     // failure_reason_e
+#include "dnc_list.h"                           // DncList
+#include "dial_plan.h"                          // DialPlan
+#include "phone_number.h"                       // PhoneNumber
 
 
 #include "namespace_lib.h"          // NAMESPACE_DIALER_START
@@ -53,6 +76,7 @@ class Dialer;
 class DetectedTone;
 class ObjectWrap;
 class SimpleVoipWrap;
+class TimerTick;
 
 typedef workt::WorkerT< const workt::IObject*, Dialer> WorkerBase;
 
@@ -77,6 +101,15 @@ public:
         CANCELED_IN_WC,    // waiting drop response before connection
     };
 
+    // published by the worker thread after each processed message
+    struct Snapshot
+    {
+        state_e     state;
+        uint32_t    call_id;
+        uint32_t            pstn_status;
+        failure_reason_e    failure_reason;
+    };
+
 public:
     Dialer();
     ~Dialer();
@@ -86,21 +119,66 @@ public:
             scheduler::IScheduler       * sched,
             uint16_t                    data_port = 0 );
 
-    bool register_callback( simple_voip::ISimpleVoipCallback * callback );
+    bool init(
+            skype_service::SkypeService * sw,
+            scheduler::IScheduler       * sched,
+            const Config                & config );
 
-    bool is_inited() const;
+    // Subscribers can be added and removed at any time after init(), each one gets
+    // the objects selected by mask (callback_mask_e). With Config::async_callback
+    // each subscriber has an own delivery thread.
+    bool register_callback( simple_voip::ISimpleVoipCallback * callback, uint32_t mask = CALLBACK_ALL );
+    bool register_callback( ITypedCallback * callback, uint32_t mask = CALLBACK_ALL );
 
+    // objects already being dispatched may still be delivered after return
+    bool unregister_callback( simple_voip::ISimpleVoipCallback * callback );
+    bool unregister_callback( ITypedCallback * callback );
+
+    // must be called before start()
+    bool register_outcome_callback( IOutcomeCallback * callback );
+
+    // calls with a larger id are hung up and answered with ERROR_CODE_CALL_ID_OUT_OF_RANGE,
+    // 0 - unlimited; must be called before start()
+    void set_max_call_id( uint32_t max_call_id );
+
+    // numbers on the list are not dialed, can be replaced at any time from any thread; nullptr - no list
+    void set_dnc_list( const std::shared_ptr<const DncList> & list );
+
+    // numbers are rewritten by the matching route and not dialed without one,
+    // can be replaced at any time from any thread; nullptr - no plan.
+    // Limits of the routes (max_calls, max_rate, burst) are not enforced by a single dialer,
+    // only by MultiDialer with a RouteLimiter
+    void set_dial_plan( const std::shared_ptr<const DialPlan> & plan );
+
+    // lock-free, can be called from any thread
+    bool is_inited() const;
     state_e get_state() const;
+    Snapshot get_snapshot() const;
+
+    const Stats & get_stats() const;
+
+    // becomes ready when the dialer reaches IDLE for the first time
+    std::shared_future<void> get_ready_future() const;
+
+    // time from start() to ready, 0 - not ready yet
+    std::chrono::milliseconds get_startup_time() const;
+
+    // returns a callback object to the pool instead of deleting it, can be called from any thread
+    void release( const simple_voip::CallbackObject * obj );
 
     // interface ISimpleVoip
     virtual void consume( const simple_voip::ForwardObject * req );
 
+    // request is answered with ERROR_CODE_REQUEST_EXPIRED if it is still queued at the deadline
+    void consume( const simple_voip::ForwardObject * req, const std::chrono::steady_clock::time_point & deadline );
+
     // interface skype_service::ICallback
     virtual void consume( const skype_service::Event * e );
 
     // interface dtmf::IDtmfDetectorCallback
     virtual void on_detect( dtmf::tone_e button );
 
+    // queries the account status instead of waiting for it to be pushed
     void start();
 
     // interface IControllable
@@ -116,6 +194,7 @@ private:
     void handle( const simple_voip::PlayFileStopRequest * req );
     void handle( const simple_voip::RecordFileRequest * req );
     void handle( const SimpleVoipWrap * req );
+    void handle( const simple_voip::ForwardObject * req, const std::chrono::steady_clock::time_point & deadline );
     void handle( const ObjectWrap * req );
 
     // interface skype_service::ICallback
@@ -134,6 +213,9 @@ private:
     void handle( const skype_service::CallFailureReasonEvent * e );
 
     void handle( const DetectedTone * ev );
+    void handle( const TimerTick * ev );
+
+    void ticker_thread();
 
     void on_unknown( const std::string & s );
 
@@ -143,57 +225,146 @@ private:
     void handle_in_state_w_conn( const skype_service::Event * ev );
     void handle_in_state_connected( const skype_service::Event * ev );
     void handle_in_state_w_drpr( const skype_service::Event * ev );
+    void handle_disconnect( const skype_service::Event * ev );
 
     void forward_to_player( const skype_service::Event * ev );
+    bool is_media_response( const skype_service::Event * ev ) const;
+    void handle_media_response( const skype_service::Event * ev );
 
     void send_reject_response( uint32_t job_id, uint32_t errorcode, const std::string & descr );
     void send_error_response( uint32_t job_id, uint32_t errorcode, const std::string & descr );
 
     bool is_inited__() const;
+    void publish_snapshot();
+    void publish_snapshot( state_e state );
+    std::string get_pstn_status_descr() const;
+    static bool is_expired( const std::chrono::steady_clock::time_point & deadline );
+    void send_expired_response( const simple_voip::ForwardObject * req );
+    void enqueue_pending_request( const SimpleVoipWrap * req );
+    void process_pending_requests();
     bool is_call_id_valid( uint32_t call_id ) const;
 
-    void callback_consume( const simple_voip::CallbackObject * req );
-
     void send_reject_due_to_wrong_state( uint32_t job_id );
     bool send_reject_if_in_request_processing( uint32_t job_id );
     bool ignore_response( const skype_service::Event * ev );
     bool ignore_non_response( const skype_service::Event * ev );
     bool ignore_non_expected_response( const skype_service::Event * ev );
-    static const char* decode_failure_reason( uint32_t c );
+    bool is_online() const;
+    bool is_do_not_call( const PhoneNumber & number );
+    bool route_party( const std::string & party, const PhoneNumber & number, std::string * outp );
     void switch_to_ready_if_possible();
+    void warm_up();
+    void signal_ready();
+    void reject_pending_requests( uint32_t errorcode, const std::string & descr );
+    void reject_pending_requests_of_call( uint32_t call_id );
     void switch_to_idle_and_cleanup();
+    void send_outcome( uint32_t req_id, call_result_e result );
+    void finish_outcome( call_result_e result );
+    void set_outcome_timing( CallOutcome * o ) const;
+    void next_state( state_e state );
+
+    void restart_watchdog();
+    void on_watchdog( state_e state );
+    void abandon_call( uint32_t call_id );
+    uint32_t next_hangup_job_id();
+    void forget_later( std::set<uint32_t> * ids, uint32_t id );
+
+    bool play_voicemail_prompt();
+    void on_voicemail_prompt_end( uint32_t call_id );
+    void cancel_voicemail_prompt();
+    void drop_voicemail();
+    bool ignore_abandoned_call( const skype_service::Event * ev );
+    static bool get_call_id( const skype_service::Event * ev, uint32_t * call_id );
 
     static simple_voip::DtmfTone::tone_e decode_tone( dtmf::tone_e tone );
 
-    enum class party_e
+    static uint32_t get_req_id( const simple_voip::ForwardObject * req );
+    static uint32_t get_call_id( const simple_voip::ForwardObject * req );     // 0 - not call-scoped
+
+    enum class media_op_e
+    {
+        PLAY,
+        PLAY_STOP,
+        RECORD
+    };
+
+    struct PendingRequest
     {
-        UNKNOWN,
-        NUMBER,
-        SYMBOLIC
+        const simple_voip::ForwardObject        * obj;
+        std::chrono::steady_clock::time_point   deadline;
     };
-    static party_e get_party_type( const std::string & inp );
-    static bool transform_party( const std::string & inp, std::string & outp );
 
 private:
     mutable std::mutex          mutex_;
 
+    std::atomic<bool>           is_inited_;
+    SeqLockT<Snapshot>          snapshot_;
+
     state_e                     state_;
 
     skype_service::SkypeService * sio_;
     scheduler::IScheduler       * sched_;
-    simple_voip::ISimpleVoipCallback  * callback_;
-    uint16_t                    data_port_;
+    Config                      config_;
 
     uint32_t                    current_job_id_;
+    std::deque<PendingRequest>  pending_requests_;  // FIFO of requests waiting for current_job_id_
     uint32_t                    call_id_;
+    uint32_t                    max_call_id_;       // 0 - unlimited
     skype_service::conn_status_e   cs_;
     skype_service::user_status_e   us_;
-    uint32_t                    failure_reason_;
-    std::string                 failure_reason_msg_;
+    failure_reason_e            failure_reason_;
     uint32_t                    pstn_status_;
-    std::string                 pstn_status_msg_;
+    std::string                 pstn_status_msg_;   // text of the service, empty - get_pstn_status_text() is used
+
+    uint32_t                    outcome_req_id_;    // InitiateCallRequest whose outcome is pending, 0 - none
+    bool                        is_call_connected_;
+    std::chrono::steady_clock::time_point   dial_time_;         // call timing of the outcome
+    std::chrono::steady_clock::time_point   ringing_time_;
+    std::chrono::steady_clock::time_point   connected_time_;
+    std::vector<IOutcomeCallback*>  outcome_callbacks_;
+
+    std::shared_ptr<const DncList>  dnc_list_;          // published by set_dnc_list()
+    std::atomic<uint32_t>           dnc_list_version_;
+    std::shared_ptr<const DncList>  dnc_list_cached_;   // of the worker thread
+    uint32_t                        dnc_list_cached_version_;
+
+    std::shared_ptr<const DialPlan> dial_plan_;         // published by set_dial_plan()
+    std::atomic<uint32_t>           dial_plan_version_;
+    std::shared_ptr<const DialPlan> dial_plan_cached_;  // of the worker thread
+    uint32_t                        dial_plan_cached_version_;
+
+    std::map<uint32_t,media_op_e>   media_ops_;     // outstanding media requests of the call: req_id -> operation
+
+    TimerWheel                  timers_;            // accessed by the worker thread only
+    TimerWheel::timer_id_t      watchdog_id_;
+
+    std::chrono::steady_clock::time_point   voicemail_time_;    // of detection, unset - no voicemail
+    uint32_t                    voicemail_duration_;    // reported with the detection, seconds
+    bool                        is_voicemail_prompt_;   // prompt playing, the call is dropped at its end
+    TimerWheel::timer_id_t      voicemail_timer_id_;
+
+    // entries are removed by the reply they wait for, at the latest after ABANDONED_TTL_MS
+    std::set<uint32_t>          abandoned_job_ids_;     // call initiations given up by the watchdog
+    std::set<uint32_t>          abandoned_call_ids_;    // calls hung up by the watchdog, events are ignored
+    std::set<uint32_t>          hangup_job_ids_;        // internal requests (hang up, voicemail prompt), responses are ignored
+    uint32_t                    last_hangup_job_id_;
+    std::thread                 ticker_;
+    std::atomic<bool>           must_stop_ticker_;
+    std::atomic<bool>           is_tick_pending_;
+
+    std::chrono::steady_clock::time_point   start_time_;
+    std::promise<void>          ready_promise_;
+    std::shared_future<void>    ready_future_;
+    bool                        is_ready_signalled_;
+    std::atomic<uint32_t>       startup_time_ms_;
+
+    CallbackObjectPool          pool_;              // must outlive the objects sent by the worker and player_
+
+    CallbackDispatcher          dispatcher_;
 
     PlayerSM                    player_;
+
+    Stats                       stats_;
 };
 
 NAMESPACE_DIALER_END
@@ -0,0 +1,186 @@
+/*
+
+Do-not-call list.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+// $Revision: 12038 $ $Date:: 2019-09-25 #$ $Author: serge $
+
+#include "dnc_list.h"               // self
+
+#include <algorithm>                // std::upper_bound
+#include <cstring>                  // memcmp
+#include <cstdio>                   // fopen
+#include <sys/mman.h>               // mmap
+#include <sys/stat.h>               // fstat
+#include <fcntl.h>                  // open
+#include <unistd.h>                 // close
+
+#include "../utils/dummy_logger.h"  // dummy_log
+
+#define MODULENAME      "DncList"
+
+NAMESPACE_DIALER_START
+
+const char DncList::MAGIC[8] = { 'D', 'N', 'C', 'L', 'I', 'S', 'T', '1' };
+
+DncList::DncList():
+    map_( nullptr ),
+    map_size_( 0 ),
+    data_( nullptr ),
+    size_( 0 )
+{
+}
+
+DncList::~DncList()
+{
+    if( map_ )
+        munmap( map_, map_size_ );
+}
+
+std::shared_ptr<const DncList> DncList::load( const std::string & filename )
+{
+    int fd = open( filename.c_str(), O_RDONLY );
+
+    if( fd < 0 )
+    {
+        dummy_log_error( MODULENAME, "cannot open %s", filename.c_str() );
+        return nullptr;
+    }
+
+    struct stat st;
+
+    if( fstat( fd, & st ) != 0 || static_cast<size_t>( st.st_size ) < sizeof( Header ) )
+    {
+        dummy_log_error( MODULENAME, "%s: invalid file", filename.c_str() );
+        close( fd );
+        return nullptr;
+    }
+
+    // the mapping stays valid after close
+    void * p = mmap( nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+
+    close( fd );
+
+    if( p == MAP_FAILED )
+    {
+        dummy_log_error( MODULENAME, "cannot map %s", filename.c_str() );
+        return nullptr;
+    }
+
+    std::shared_ptr<DncList> res( new DncList );
+
+    res->map_       = p;
+    res->map_size_  = st.st_size;
+
+    auto h = static_cast<const Header*>( p );
+
+    if( memcmp( h->magic, MAGIC, sizeof( MAGIC ) ) != 0 || h->size != ( st.st_size - sizeof( Header ) ) / sizeof( uint64_t ) )
+    {
+        dummy_log_error( MODULENAME, "%s: invalid header", filename.c_str() );
+        return nullptr;
+    }
+
+    res->data_  = reinterpret_cast<const uint64_t*>( h + 1 );
+    res->size_  = h->size;
+
+    res->index_1_.reserve( res->size_ / STRIDE + 1 );
+
+    // the lookup relies on the order, one pass over the file checks it while building the index
+    for( uint64_t i = 0; i < res->size_; ++i )
+    {
+        if( i > 0 && res->data_[i] <= res->data_[i - 1] )
+        {
+            dummy_log_error( MODULENAME, "%s: values not sorted at %llu", filename.c_str(), (unsigned long long) i );
+            return nullptr;
+        }
+
+        if( i % STRIDE == 0 )
+            res->index_1_.push_back( res->data_[i] );
+    }
+
+    res->index_0_.reserve( res->index_1_.size() / STRIDE + 1 );
+
+    for( size_t i = 0; i < res->index_1_.size(); i += STRIDE )
+        res->index_0_.push_back( res->index_1_[i] );
+
+    dummy_log_info( MODULENAME, "loaded %s: %llu number(s)", filename.c_str(), (unsigned long long) res->size_ );
+
+    return res;
+}
+
+bool DncList::write( const std::string & filename, std::vector<uint64_t> numbers )
+{
+    std::sort( numbers.begin(), numbers.end() );
+
+    numbers.erase( std::unique( numbers.begin(), numbers.end() ), numbers.end() );
+
+    FILE * f = fopen( filename.c_str(), "wb" );
+
+    if( f == nullptr )
+    {
+        dummy_log_error( MODULENAME, "cannot create %s", filename.c_str() );
+        return false;
+    }
+
+    Header h;
+
+    memcpy( h.magic, MAGIC, sizeof( MAGIC ) );
+    h.size  = numbers.size();
+
+    bool b = fwrite( & h, sizeof( h ), 1, f ) == 1 &&
+            ( numbers.empty() || fwrite( numbers.data(), sizeof( uint64_t ), numbers.size(), f ) == numbers.size() );
+
+    b = ( fclose( f ) == 0 ) && b;
+
+    if( b == false )
+        dummy_log_error( MODULENAME, "cannot write %s", filename.c_str() );
+
+    return b;
+}
+
+bool DncList::contains( uint64_t number ) const
+{
+    // index_0_ -> STRIDE values of index_1_ -> STRIDE values of data_
+    auto it_0 = std::upper_bound( index_0_.begin(), index_0_.end(), number );
+
+    if( it_0 == index_0_.begin() )
+        return false;
+
+    size_t b_1 = ( it_0 - index_0_.begin() - 1 ) * STRIDE;
+    size_t e_1 = std::min<size_t>( b_1 + STRIDE, index_1_.size() );
+
+    auto it_1 = std::upper_bound( index_1_.begin() + b_1, index_1_.begin() + e_1, number );
+
+    uint64_t b = ( it_1 - index_1_.begin() - 1 ) * STRIDE;
+    uint64_t e = std::min<uint64_t>( b + STRIDE, size_ );
+
+    return std::binary_search( data_ + b, data_ + e, number );
+}
+
+bool DncList::contains( const PhoneNumber & number ) const
+{
+    return number.is_valid() && contains( number.get_value() );
+}
+
+uint64_t DncList::get_size() const
+{
+    return size_;
+}
+
+NAMESPACE_DIALER_END
@@ -0,0 +1,90 @@
+/*
+
+Do-not-call list.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+// $Revision: 12038 $ $Date:: 2019-09-25 #$ $Author: serge $
+
+#ifndef LIB_DIALER_DNC_LIST_H
+#define LIB_DIALER_DNC_LIST_H
+
+#include <cstdint>                  // uint64_t
+#include <string>                   // std::string
+#include <vector>                   // std::vector
+#include <memory>                   // std::shared_ptr
+
+#include "phone_number.h"           // PhoneNumber
+
+#include "namespace_lib.h"          // NAMESPACE_DIALER_START
+
+NAMESPACE_DIALER_START
+
+// Read-only set of numbers (values of PhoneNumber), mapped from a file of sorted 64-bit values,
+// so the pages are shared by all processes using the same file.
+// A lookup walks two small sampled indexes and searches STRIDE values of the file.
+// The object is immutable, a new list is swapped in by replacing the shared pointer.
+class DncList
+{
+public:
+    enum
+    {
+        STRIDE  = 128
+    };
+
+public:
+    ~DncList();
+
+    // nullptr on error or if the values are not strictly increasing
+    static std::shared_ptr<const DncList> load( const std::string & filename );
+
+    // numbers are sorted and deduplicated
+    static bool write( const std::string & filename, std::vector<uint64_t> numbers );
+
+    bool contains( uint64_t number ) const;
+
+    bool contains( const PhoneNumber & number ) const;
+
+    uint64_t get_size() const;
+
+private:
+    struct Header
+    {
+        char        magic[8];
+        uint64_t    size;
+    };
+
+private:
+    DncList();
+
+    static const char MAGIC[8];
+
+private:
+    void                    * map_;
+    size_t                  map_size_;
+
+    const uint64_t          * data_;
+    uint64_t                size_;
+
+    std::vector<uint64_t>   index_1_;       // every STRIDE-th value of data_
+    std::vector<uint64_t>   index_0_;       // every STRIDE-th value of index_1_
+};
+
+NAMESPACE_DIALER_END
+
+#endif // LIB_DIALER_DNC_LIST_H
@@ -0,0 +1,50 @@
+/*
+
+Error codes.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+// $Revision: 12038 $ $Date:: 2019-09-25 #$ $Author: serge $
+
+#ifndef LIB_DIALER_ERROR_CODES_H
+#define LIB_DIALER_ERROR_CODES_H
+
+#include "namespace_lib.h"          // NAMESPACE_DIALER_START
+
+NAMESPACE_DIALER_START
+
+// error codes sent in ErrorResponse/RejectResponse,
+// start above the range used by the voip service
+enum error_code_e
+{
+    ERROR_CODE_NONE                 = 0,
+    ERROR_CODE_REQUEST_EXPIRED      = 1001,
+    ERROR_CODE_CALL_SETUP_TIMEOUT   = 1002,
+    ERROR_CODE_DROP_TIMEOUT         = 1003,
+    ERROR_CODE_NO_ACCOUNT_AVAILABLE = 1004,
+    ERROR_CODE_ACCOUNT_OFFLINE      = 1005,
+    ERROR_CODE_DO_NOT_CALL          = 1006,
+    ERROR_CODE_NO_ROUTE             = 1007,
+    ERROR_CODE_ROUTE_BUSY           = 1008,
+    ERROR_CODE_ROUTE_RATE_LIMITED   = 1009,
+    ERROR_CODE_CALL_ID_OUT_OF_RANGE = 1010,
+};
+
+NAMESPACE_DIALER_END
+
+#endif // LIB_DIALER_ERROR_CODES_H
@@ -0,0 +1,75 @@
+/*
+
+Exponentially weighted moving average.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+// $Revision: 12038 $ $Date:: 2019-09-25 #$ $Author: serge $
+
+#ifndef LIB_DIALER_EWMA_H
+#define LIB_DIALER_EWMA_H
+
+#include <cstdint>                  // uint32_t
+
+#include "namespace_lib.h"          // NAMESPACE_DIALER_START
+
+NAMESPACE_DIALER_START
+
+// Constant memory estimate of a mean, recent samples weigh more.
+// Until 1/alpha samples are seen it is the plain mean, so early samples are not underweighted.
+class Ewma
+{
+public:
+    explicit Ewma( double alpha = 0.05 ):
+        alpha_( alpha ),
+        value_( 0 ),
+        n_( 0 )
+    {
+    }
+
+    void add( double x )
+    {
+        ++n_;
+
+        double a = 1.0 / n_;
+
+        if( a < alpha_ )
+            a = alpha_;
+
+        value_ += a * ( x - value_ );
+    }
+
+    double get() const
+    {
+        return value_;
+    }
+
+    uint32_t get_num_samples() const
+    {
+        return n_;
+    }
+
+private:
+    double      alpha_;
+    double      value_;
+    uint32_t    n_;
+};
+
+NAMESPACE_DIALER_END
+
+#endif // LIB_DIALER_EWMA_H
@@ -0,0 +1,123 @@
+/*
+
+Call failure codes.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+// $Revision: 12038 $ $Date:: 2019-09-25 #$ $Author: serge $
+
+#include "failure_reason.h"         // self
+
+NAMESPACE_DIALER_START
+
+failure_reason_e decode_failure_reason( uint32_t code )
+{
+    if( code >= static_cast<uint32_t>( failure_reason_e::UNKNOWN ) )
+        return failure_reason_e::UNKNOWN;
+
+    return static_cast<failure_reason_e>( code );
+}
+
+bool is_infrastructure_failure( failure_reason_e reason )
+{
+    switch( reason )
+    {
+    case failure_reason_e::NO_PROXY_FOUND:
+    case failure_reason_e::SESSION_TERMINATED:
+    case failure_reason_e::NO_COMMON_CODEC:
+    case failure_reason_e::SOUND_IO_ERROR:
+    case failure_reason_e::SOUND_RECORDING_ERROR:
+        return true;
+    default:
+        return false;
+    }
+}
+
+const char * get_failure_reason_text( failure_reason_e reason )
+{
+    static const char* table[] =
+    {
+        "",
+        "Miscellaneous error",
+        "User or phone number does not exist. Check that a prefix is entered for the phone number, either in the form 003725555555 or +3725555555; the form 3725555555 is incorrect.",
+        "User is offline",
+        "No proxy found",
+        "Session terminated.",
+        "No common codec found.",
+        "Sound I/O error.",
+        "Problem with remote sound device.",
+        "Call blocked by recipient.",
+        "Recipient not a friend.",
+        "Current user not authorized by recipient.",
+        "Sound recording error.",
+        "Failure to call a commercial contact.",
+        "Conference call has been dropped by the host. Note that this does not normally indicate abnormal call termination. Call being dropped for all the participants when the conference host leavs the call is expected behaviour.",
+        "Unknown failure reason"
+    };
+
+    static_assert( sizeof( table ) / sizeof( table[0] ) == static_cast<uint32_t>( failure_reason_e::UNKNOWN ) + 1, "table size mismatch" );
+
+    return table[ static_cast<uint32_t>( reason ) ];
+}
+
+const char * get_pstn_status_text( uint32_t code )
+{
+    struct Entry
+    {
+        uint32_t    code;
+        const char  * text;
+    };
+
+    // sorted by code
+    static const Entry table[] =
+    {
+        { 400, "Bad Request" },
+        { 401, "Unauthorized" },
+        { 402, "Payment Required" },
+        { 403, "Forbidden" },
+        { 404, "Not Found" },
+        { 408, "Request Timeout" },
+        { 410, "Gone" },
+        { 480, "Temporarily Unavailable" },
+        { 484, "Address Incomplete" },
+        { 486, "Busy Here" },
+        { 487, "Request Terminated" },
+        { 488, "Not Acceptable Here" },
+        { 500, "Server Internal Error" },
+        { 502, "Bad Gateway" },
+        { 503, "Service Unavailable" },
+        { 504, "Server Time-out" },
+        { 600, "Busy Everywhere" },
+        { 603, "Decline" },
+        { 604, "Does Not Exist Anywhere" },
+        { 606, "Not Acceptable" },
+    };
+
+    for( const auto & e : table )
+    {
+        if( e.code == code )
+            return e.text;
+
+        if( e.code > code )
+            break;
+    }
+
+    return "";
+}
+
+NAMESPACE_DIALER_END
@@ -0,0 +1,67 @@
+/*
+
+Call failure codes.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+// $Revision: 12038 $ $Date:: 2019-09-25 #$ $Author: serge $
+
+#ifndef LIB_DIALER_FAILURE_REASON_H
+#define LIB_DIALER_FAILURE_REASON_H
+
+#include <cstdint>                  // uint8_t
+
+#include "namespace_lib.h"          // NAMESPACE_DIALER_START
+
+NAMESPACE_DIALER_START
+
+// failure reasons reported by the voip service, values are stable
+enum class failure_reason_e : uint8_t
+{
+    NONE                        = 0,
+    MISC_ERROR                  = 1,
+    USER_DOES_NOT_EXIST         = 2,
+    USER_OFFLINE                = 3,
+    NO_PROXY_FOUND              = 4,
+    SESSION_TERMINATED          = 5,
+    NO_COMMON_CODEC             = 6,
+    SOUND_IO_ERROR              = 7,
+    REMOTE_SOUND_DEVICE_ERROR   = 8,
+    BLOCKED_BY_RECIPIENT        = 9,
+    RECIPIENT_NOT_FRIEND        = 10,
+    NOT_AUTHORIZED_BY_RECIPIENT = 11,
+    SOUND_RECORDING_ERROR       = 12,
+    COMMERCIAL_CONTACT          = 13,
+    DROPPED_BY_HOST             = 14,
+    UNKNOWN                     = 15,   // code not known to this version
+};
+
+failure_reason_e decode_failure_reason( uint32_t code );
+
+// failures of the voip client or the network rather than of the called party
+bool is_infrastructure_failure( failure_reason_e reason );
+
+// description of the code, only needed for humans
+const char * get_failure_reason_text( failure_reason_e reason );
+
+// description of a PSTN status (SIP response code), empty if unknown
+const char * get_pstn_status_text( uint32_t code );
+
+NAMESPACE_DIALER_END
+
+#endif // LIB_DIALER_FAILURE_REASON_H
@@ -0,0 +1,50 @@
+/*
+
+Batch callback interface.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+// $Revision: 12038 $ $Date:: 2019-09-25 #$ $Author: serge $
+
+#ifndef LIB_DIALER_I_BATCH_CALLBACK_H
+#define LIB_DIALER_I_BATCH_CALLBACK_H
+
+#include <cstdint>                  // uint32_t
+
+#include "namespace_lib.h"          // NAMESPACE_DIALER_START
+
+namespace simple_voip
+{
+class CallbackObject;
+}
+
+NAMESPACE_DIALER_START
+
+// Optionally implemented by a client callback in addition to ISimpleVoipCallback.
+// Objects are passed in the order they were produced, the client takes ownership of them.
+class IBatchCallback
+{
+public:
+    virtual ~IBatchCallback() {}
+
+    virtual void consume_batch( const simple_voip::CallbackObject * const * objs, uint32_t size ) = 0;
+};
+
+NAMESPACE_DIALER_END
+
+#endif // LIB_DIALER_I_BATCH_CALLBACK_H
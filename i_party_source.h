@@ -0,0 +1,48 @@
+/*
+
+Party source interface.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+// $Revision: 12038 $ $Date:: 2019-09-25 #$ $Author: serge $
+
+#ifndef LIB_DIALER_I_PARTY_SOURCE_H
+#define LIB_DIALER_I_PARTY_SOURCE_H
+
+#include <cstdint>                  // uint32_t
+#include <string>                   // std::string
+#include <vector>                   // std::vector
+
+#include "namespace_lib.h"          // NAMESPACE_DIALER_START
+
+NAMESPACE_DIALER_START
+
+// parties pulled by a campaign when its queue runs low
+class IPartySource
+{
+public:
+    virtual ~IPartySource() {}
+
+    // appends up to max_size parties, must not block;
+    // returns false if the source is exhausted and nothing was appended
+    virtual bool get_parties( std::vector<std::string> * parties, uint32_t max_size ) = 0;
+};
+
+NAMESPACE_DIALER_END
+
+#endif // LIB_DIALER_I_PARTY_SOURCE_H
@@ -0,0 +1,58 @@
+/*
+
+Typed callback interface.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+// $Revision: 12038 $ $Date:: 2019-09-25 #$ $Author: serge $
+
+#ifndef LIB_DIALER_I_TYPED_CALLBACK_H
+#define LIB_DIALER_I_TYPED_CALLBACK_H
+
+#include "../simple_voip/objects.h" // simple_voip::InitiateCallResponse, ...
+
+#include "namespace_lib.h"          // NAMESPACE_DIALER_START
+
+NAMESPACE_DIALER_START
+
+// Alternative to ISimpleVoipCallback: one method per message type, no typeid on the client side.
+// Objects are owned by the dialer and are only valid during the call.
+class ITypedCallback
+{
+public:
+    virtual ~ITypedCallback() {}
+
+    virtual void on_initiate_call_response( const simple_voip::InitiateCallResponse & obj ) = 0;
+    virtual void on_error_response( const simple_voip::ErrorResponse & obj ) = 0;
+    virtual void on_reject_response( const simple_voip::RejectResponse & obj ) = 0;
+    virtual void on_drop_response( const simple_voip::DropResponse & obj ) = 0;
+    virtual void on_play_file_response( const simple_voip::PlayFileResponse & obj ) = 0;
+    virtual void on_play_file_stop_response( const simple_voip::PlayFileStopResponse & obj ) = 0;
+    virtual void on_record_file_response( const simple_voip::RecordFileResponse & obj ) = 0;
+    virtual void on_dialing( const simple_voip::Dialing & obj ) = 0;
+    virtual void on_ringing( const simple_voip::Ringing & obj ) = 0;
+    virtual void on_connected( const simple_voip::Connected & obj ) = 0;
+    virtual void on_failed( const simple_voip::Failed & obj ) = 0;
+    virtual void on_connection_lost( const simple_voip::ConnectionLost & obj ) = 0;
+    virtual void on_dtmf_tone( const simple_voip::DtmfTone & obj ) = 0;
+    virtual void on_call_duration( const simple_voip::CallDuration & obj ) = 0;
+};
+
+NAMESPACE_DIALER_END
+
+#endif // LIB_DIALER_I_TYPED_CALLBACK_H
@@ -0,0 +1,647 @@
+/*
+
+Multi-account dialer.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+// $Revision: 12038 $ $Date:: 2019-09-25 #$ $Author: serge $
+
+#include "multi_dialer.h"           // self
+
+#include <typeinfo>                 // typeid
+
+#include "../simple_voip/objects.h"         // InitiateCallRequest
+#include "../simple_voip/object_factory.h"  // create_reject_response
+#include "../utils/dummy_logger.h"          // dummy_log
+#include "../utils/mutex_helper.h"          // MUTEX_SCOPE_LOCK
+#include "../utils/utils_assert.h"          // ASSERT
+
+#include "error_codes.h"            // ERROR_CODE_NO_ACCOUNT_AVAILABLE
+#include "phone_number.h"           // PhoneNumber
+
+#define MODULENAME      "MultiDialer"
+
+NAMESPACE_DIALER_START
+
+MultiDialer::AccountCallback::AccountCallback( MultiDialer * parent, uint32_t index ):
+    parent_( parent ),
+    index_( index )
+{
+}
+
+void MultiDialer::AccountCallback::consume( const simple_voip::CallbackObject * obj )
+{
+    parent_->on_callback( index_, obj );
+}
+
+void MultiDialer::AccountCallback::on_call_outcome( const CallOutcome & outcome )
+{
+    parent_->on_call_outcome( index_, outcome );
+}
+
+MultiDialer::MultiDialer():
+    is_aimd_enabled_( false ),
+    aimd_config_(),
+    callback_( nullptr )
+{
+}
+
+MultiDialer::~MultiDialer()
+{
+}
+
+bool MultiDialer::add_account( Dialer * dialer, uint32_t weight )
+{
+    ASSERT( dialer );
+
+    if( weight == 0 )
+    {
+        dummy_log_error( MODULENAME, "add_account: weight must not be 0" );
+        return false;
+    }
+
+    if( accounts_.size() >= MAX_ACCOUNTS )
+    {
+        dummy_log_error( MODULENAME, "add_account: too many accounts, max %u", MAX_ACCOUNTS );
+        return false;
+    }
+
+    uint32_t index = accounts_.size();
+
+    // the account index is encoded into the call id, larger ids are refused by the dialer
+    dialer->set_max_call_id( MAX_LOCAL_CALL_ID );
+
+    Account a = { dialer, weight, 0, false, false, std::string(), nullptr, AimdLimiter( aimd_config_, 1.0 ),
+            std::unique_ptr<AccountCallback>( new AccountCallback( this, index ) ) };
+
+    if( dialer->register_callback( static_cast<simple_voip::ISimpleVoipCallback*>( a.callback.get() ) ) == false )
+    {
+        dummy_log_error( MODULENAME, "add_account: cannot register callback" );
+        return false;
+    }
+
+    if( dialer->register_outcome_callback( a.callback.get() ) == false )
+    {
+        dummy_log_error( MODULENAME, "add_account: cannot register outcome callback" );
+        dialer->unregister_callback( static_cast<simple_voip::ISimpleVoipCallback*>( a.callback.get() ) );
+        return false;
+    }
+
+    accounts_.push_back( std::move( a ) );
+
+    dummy_log_info( MODULENAME, "add_account: account %u, weight %u", index, weight );
+
+    return true;
+}
+
+bool MultiDialer::register_callback( simple_voip::ISimpleVoipCallback * callback )
+{
+    if( callback == nullptr )
+        return false;
+
+    if( callback_ != nullptr )
+        return false;
+
+    callback_   = callback;
+
+    return true;
+}
+
+bool MultiDialer::register_outcome_callback( IOutcomeCallback * callback )
+{
+    if( callback == nullptr )
+        return false;
+
+    outcome_callbacks_.push_back( callback );
+
+    return true;
+}
+
+void MultiDialer::set_dial_plan( const std::shared_ptr<const DialPlan> & plan )
+{
+    set_dial_plan( plan, plan ? std::make_shared<RouteLimiter>( * plan ) : nullptr );
+}
+
+void MultiDialer::set_dial_plan( const std::shared_ptr<const DialPlan> & plan, const std::shared_ptr<RouteLimiter> & limiter )
+{
+    {
+        MUTEX_SCOPE_LOCK( mutex_ );
+
+        dial_plan_      = plan;
+        route_limiter_  = limiter;
+    }
+
+    // the dialers rewrite the numbers by the same plan
+    for( auto & a : accounts_ )
+        a.dialer->set_dial_plan( plan );
+}
+
+void MultiDialer::enable_aimd( const AimdLimiter::Config & config )
+{
+    MUTEX_SCOPE_LOCK( mutex_ );
+
+    is_aimd_enabled_    = true;
+    aimd_config_        = config;
+
+    // an account has one call at most
+    for( auto & a : accounts_ )
+        a.aimd  = AimdLimiter( config, 1.0 );
+
+    route_aimd_.clear();
+
+    dummy_log_info( MODULENAME, "enable_aimd: increase %.2f, decrease %.2f, hold %u ms", config.increase, config.decrease, config.hold_ms );
+}
+
+void MultiDialer::consume( const simple_voip::ForwardObject * req )
+{
+    if( typeid( *req ) == typeid( simple_voip::InitiateCallRequest ) )
+    {
+        route_initiate_call( dynamic_cast< const simple_voip::InitiateCallRequest *>( req ) );
+    }
+    else
+    {
+        route_call_request( req );
+    }
+}
+
+uint32_t MultiDialer::get_num_accounts() const
+{
+    return accounts_.size();
+}
+
+void MultiDialer::get_snapshots( std::vector<Dialer::Snapshot> * snapshots ) const
+{
+    snapshots->clear();
+    snapshots->reserve( accounts_.size() );
+
+    for( const auto & a : accounts_ )
+        snapshots->push_back( a.dialer->get_snapshot() );
+}
+
+const Stats & MultiDialer::get_stats() const
+{
+    return stats_;
+}
+
+double MultiDialer::get_account_limit( uint32_t index ) const
+{
+    MUTEX_SCOPE_LOCK( mutex_ );
+
+    if( index >= accounts_.size() )
+        return 0;
+
+    return accounts_[ index ].aimd.get_value();
+}
+
+double MultiDialer::get_route_limit( const std::string & prefix ) const
+{
+    MUTEX_SCOPE_LOCK( mutex_ );
+
+    auto it = route_aimd_.find( prefix );
+
+    if( it != route_aimd_.end() )
+        return it->second.get_value();
+
+    // not dialed so far, not limited below its max
+    if( dial_plan_ )
+    {
+        for( uint32_t i = 0; i < dial_plan_->get_num_routes(); ++i )
+        {
+            auto & route = dial_plan_->get_route( i );
+
+            if( route.prefix == prefix )
+                return get_route_max_limit__( route );
+        }
+    }
+
+    return 0;
+}
+
+void MultiDialer::route_initiate_call( const simple_voip::InitiateCallRequest * req )
+{
+    int32_t index           = -1;
+    auto    limit           = RouteLimiter::result_e::OK;
+    bool    is_throttled    = false;
+
+    {
+        MUTEX_SCOPE_LOCK( mutex_ );
+
+        auto now = std::chrono::steady_clock::now();
+
+        // a number without a route is passed on, the dialer rejects it
+        const DialPlan::Route * route = nullptr;
+
+        PhoneNumber number;
+
+        if( dial_plan_ && PhoneNumber::parse( req->party, & number ) )
+            route = dial_plan_->find( number );
+
+        if( route && is_aimd_enabled_ )
+            is_throttled    = is_route_throttled__( * route, now );
+
+        if( is_throttled == false )
+            index = select_account__( route, now );
+
+        // asked only when an account is available, so no token is spent on a rejected call
+        if( index >= 0 && route && route_limiter_ )
+        {
+            limit = route_limiter_->try_acquire( route->prefix );
+
+            if( limit != RouteLimiter::result_e::OK )
+                index = -1;
+        }
+
+        if( index >= 0 )
+        {
+            auto & a = accounts_[ index ];
+
+            a.is_reserved   = true;
+            a.has_route     = ( route != nullptr );
+            a.route         = route ? route->prefix : std::string();
+
+            if( route && route_limiter_ )
+                a.limiter   = route_limiter_;
+        }
+    }
+
+    if( is_throttled )
+    {
+        dummy_log_debug( MODULENAME, "req id %u: route of %s is throttled", req->req_id, req->party.c_str() );
+
+        reject_initiate_call( req, counter_e::ROUTE_THROTTLED, ERROR_CODE_ROUTE_BUSY, "route throttled" );
+
+        return;
+    }
+
+    if( limit == RouteLimiter::result_e::BUSY )
+    {
+        dummy_log_info( MODULENAME, "req id %u: route of %s is busy", req->req_id, req->party.c_str() );
+
+        reject_initiate_call( req, counter_e::ROUTE_BUSY, ERROR_CODE_ROUTE_BUSY, "route busy" );
+
+        return;
+    }
+
+    if( limit == RouteLimiter::result_e::RATE_LIMITED )
+    {
+        dummy_log_debug( MODULENAME, "req id %u: route of %s is rate limited", req->req_id, req->party.c_str() );
+
+        reject_initiate_call( req, counter_e::ROUTE_RATE_LIMITED, ERROR_CODE_ROUTE_RATE_LIMITED, "route rate limited" );
+
+        return;
+    }
+
+    if( index < 0 )
+    {
+        dummy_log_warn( MODULENAME, "req id %u: no account available", req->req_id );
+
+        reject_initiate_call( req, counter_e::NO_ACCOUNT_AVAILABLE, ERROR_CODE_NO_ACCOUNT_AVAILABLE, "no account available" );
+
+        return;
+    }
+
+    dummy_log_debug( MODULENAME, "req id %u: routed to account %u", req->req_id, index );
+
+    accounts_[ index ].dialer->consume( req );
+}
+
+template< class _T >
+static uint32_t * get_call_id_t( const simple_voip::ForwardObject * req )
+{
+    // the request is owned by the receiver, so it can be modified in place
+    return & const_cast< _T *>( dynamic_cast< const _T *>( req ) )->call_id;
+}
+
+void MultiDialer::route_call_request( const simple_voip::ForwardObject * req )
+{
+    uint32_t * call_id = nullptr;
+
+    if( typeid( *req ) == typeid( simple_voip::DropRequest ) )
+        call_id = get_call_id_t<simple_voip::DropRequest>( req );
+    else if( typeid( *req ) == typeid( simple_voip::PlayFileRequest ) )
+        call_id = get_call_id_t<simple_voip::PlayFileRequest>( req );
+    else if( typeid( *req ) == typeid( simple_voip::PlayFileStopRequest ) )
+        call_id = get_call_id_t<simple_voip::PlayFileStopRequest>( req );
+    else if( typeid( *req ) == typeid( simple_voip::RecordFileRequest ) )
+        call_id = get_call_id_t<simple_voip::RecordFileRequest>( req );
+
+    uint32_t index  = 0;
+
+    if( call_id )
+        * call_id   = to_local_call_id( * call_id, & index );
+
+    if( call_id == nullptr || index >= accounts_.size() )
+    {
+        dummy_log_error( MODULENAME, "cannot route request %s", typeid( *req ).name() );
+
+        auto r = dynamic_cast< const simple_voip::Request *>( req );
+
+        if( r )
+            send_reject_response( r->req_id, 0, "unknown call id" );
+
+        delete req;
+
+        return;
+    }
+
+    accounts_[ index ].dialer->consume( req );
+}
+
+int32_t MultiDialer::select_account__( const DialPlan::Route * route, const AimdLimiter::time_point & now )
+{
+    // private: no mutex lock
+
+    int32_t res = find_account__( route, now, is_aimd_enabled_ );
+
+    // suspended accounts are probed while nothing else is in flight, otherwise
+    // all requests would be rejected and no outcome would ever raise the limits
+    if( res < 0 && is_aimd_enabled_ && get_num_reserved__() == 0 )
+        res = find_account__( route, now, false );
+
+    return res;
+}
+
+int32_t MultiDialer::find_account__( const DialPlan::Route * route, const AimdLimiter::time_point & now, bool is_aimd_applied )
+{
+    // private: no mutex lock
+
+    // the route lists its accounts by cost, the first idle one is taken
+    if( route && route->accounts.empty() == false )
+    {
+        for( auto i : route->accounts )
+        {
+            if( i < accounts_.size() && is_idle__( accounts_[ i ], now, is_aimd_applied ) )
+                return i;
+        }
+
+        return -1;
+    }
+
+    // smooth weighted round-robin over idle accounts: each candidate gains its weight,
+    // the leader is picked and loses the sum of weights, so accounts are interleaved
+    int32_t     res         = -1;
+    int32_t     total       = 0;
+
+    for( uint32_t i = 0; i < accounts_.size(); ++i )
+    {
+        auto & a = accounts_[ i ];
+
+        if( is_idle__( a, now, is_aimd_applied ) == false )
+            continue;
+
+        a.current_weight    += a.weight;
+        total               += a.weight;
+
+        if( res < 0 || a.current_weight > accounts_[ res ].current_weight )
+            res = i;
+    }
+
+    if( res >= 0 )
+        accounts_[ res ].current_weight -= total;
+
+    return res;
+}
+
+bool MultiDialer::is_idle__( Account & a, const AimdLimiter::time_point & now, bool is_aimd_applied )
+{
+    // private: no mutex lock
+
+    // an unreserved account has no call, the snapshot may still show the last one,
+    // but the request is queued by the dialer behind the end of that call
+    if( a.is_reserved || a.dialer->get_state() == Dialer::UNKNOWN )
+        return false;
+
+    // a limit below 1 suspends the account until it is probed again
+    return is_aimd_applied == false || a.aimd.get_limit( now ) >= 1;
+}
+
+bool MultiDialer::is_route_throttled__( const DialPlan::Route & route, const AimdLimiter::time_point & now )
+{
+    // private: no mutex lock
+
+    double max_limit = get_route_max_limit__( route );
+
+    auto it = route_aimd_.find( route.prefix );
+
+    if( it == route_aimd_.end() )
+        it = route_aimd_.insert( std::make_pair( route.prefix, AimdLimiter( aimd_config_, max_limit ) ) ).first;
+    else
+        it->second.set_max_limit( max_limit );
+
+    // one call at a time is always allowed, see select_account__()
+    auto num_calls = get_num_route_calls__( route.prefix );
+
+    return num_calls > 0 && num_calls >= it->second.get_limit( now );
+}
+
+double MultiDialer::get_route_max_limit__( const DialPlan::Route & route ) const
+{
+    // private: no mutex lock
+
+    return ( route.max_calls > 0 ) ? route.max_calls : accounts_.size();
+}
+
+uint32_t MultiDialer::get_num_reserved__() const
+{
+    // private: no mutex lock
+
+    uint32_t res = 0;
+
+    for( const auto & a : accounts_ )
+    {
+        if( a.is_reserved )
+            ++res;
+    }
+
+    return res;
+}
+
+uint32_t MultiDialer::get_num_route_calls__( const std::string & prefix ) const
+{
+    // private: no mutex lock
+
+    uint32_t res = 0;
+
+    for( const auto & a : accounts_ )
+    {
+        if( a.is_reserved && a.has_route && a.route == prefix )
+            ++res;
+    }
+
+    return res;
+}
+
+void MultiDialer::update_aimd__( Account & a, const CallOutcome & outcome )
+{
+    // private: no mutex lock
+
+    AimdLimiter * route_aimd = nullptr;
+
+    if( a.has_route )
+    {
+        auto it = route_aimd_.find( a.route );
+
+        if( it != route_aimd_.end() )
+            route_aimd = & it->second;
+    }
+
+    if( is_infrastructure_failure( outcome.failure_reason ) )
+    {
+        auto now = std::chrono::steady_clock::now();
+
+        bool b = a.aimd.on_failure( now );
+
+        if( route_aimd )
+            b = route_aimd->on_failure( now ) || b;
+
+        if( b )
+        {
+            dummy_log_info( MODULENAME, "req id %u: %s, limits decreased", outcome.req_id, get_failure_reason_text( outcome.failure_reason ) );
+
+            stats_.inc( counter_e::AIMD_DECREASES );
+        }
+    }
+    else if( outcome.result == call_result_e::COMPLETED || outcome.result == call_result_e::CONNECTION_LOST )
+    {
+        a.aimd.on_success();
+
+        if( route_aimd )
+            route_aimd->on_success();
+    }
+}
+
+void MultiDialer::on_callback( uint32_t index, const simple_voip::CallbackObject * obj )
+{
+    // called by the worker thread of the account
+
+    auto * o = const_cast< simple_voip::CallbackObject *>( obj );
+
+    uint32_t call_id = 0;
+
+    if( typeid( *obj ) == typeid( simple_voip::InitiateCallResponse ) )
+    {
+        auto * r = static_cast< simple_voip::InitiateCallResponse *>( o );
+
+        call_id     = r->call_id;
+        r->call_id  = to_global_call_id( index, r->call_id );
+    }
+    else
+    {
+        auto * r = dynamic_cast< simple_voip::CallbackCallObject *>( o );
+
+        if( r )
+        {
+            call_id     = r->call_id;
+            r->call_id  = to_global_call_id( index, r->call_id );
+        }
+    }
+
+    if( call_id > MAX_LOCAL_CALL_ID )
+    {
+        // not expected, the dialer hangs up such calls, but the id must not alias another call
+        dummy_log_error( MODULENAME, "account %u: call id %u exceeds %u, %s dropped", index, call_id, MAX_LOCAL_CALL_ID, typeid( *obj ).name() );
+
+        accounts_[ index ].dialer->release( obj );
+        return;
+    }
+
+    if( callback_ )
+        callback_->consume( obj );
+    else
+        accounts_[ index ].dialer->release( obj );
+}
+
+void MultiDialer::on_call_outcome( uint32_t index, const CallOutcome & outcome )
+{
+    // called by the worker thread of the account
+
+    std::shared_ptr<RouteLimiter>   limiter;
+    std::string                     route;
+
+    {
+        MUTEX_SCOPE_LOCK( mutex_ );
+
+        auto & a = accounts_[ index ];
+
+        if( is_aimd_enabled_ )
+            update_aimd__( a, outcome );
+
+        a.is_reserved = false;
+        a.has_route   = false;
+
+        limiter.swap( a.limiter );
+        route.swap( a.route );
+    }
+
+    // to the limiter the slot was taken from, even if the plan was replaced since
+    if( limiter )
+        limiter->release( route );
+
+    CallOutcome o = outcome;
+
+    if( o.call_id > MAX_LOCAL_CALL_ID )
+    {
+        dummy_log_error( MODULENAME, "account %u: call id %u exceeds %u, outcome reported without it", index, o.call_id, MAX_LOCAL_CALL_ID );
+
+        o.call_id   = 0;
+    }
+    else if( o.call_id != 0 )
+        o.call_id   = to_global_call_id( index, o.call_id );
+
+    for( auto c : outcome_callbacks_ )
+        c->on_call_outcome( o );
+}
+
+void MultiDialer::reject_initiate_call( const simple_voip::InitiateCallRequest * req, counter_e counter, uint32_t errorcode, const std::string & descr )
+{
+    stats_.inc( counter );
+
+    auto req_id = req->req_id;
+
+    delete req;
+
+    send_reject_response( req_id, errorcode, descr );
+
+    // not dialed, can be retried later
+    CallOutcome outcome = { req_id, 0, call_result_e::REJECTED, failure_reason_e::NONE, 0, 0, 0, 0 };
+
+    for( auto c : outcome_callbacks_ )
+        c->on_call_outcome( outcome );
+}
+
+void MultiDialer::send_reject_response( uint32_t req_id, uint32_t errorcode, const std::string & descr )
+{
+    if( callback_ )
+        callback_->consume( simple_voip::create_reject_response( req_id, errorcode, descr ) );
+}
+
+uint32_t MultiDialer::to_global_call_id( uint32_t index, uint32_t call_id )
+{
+    ASSERT( call_id <= MAX_LOCAL_CALL_ID );
+
+    return ( call_id << ACCOUNT_BITS ) | index;
+}
+
+uint32_t MultiDialer::to_local_call_id( uint32_t call_id, uint32_t * index )
+{
+    * index = call_id & ( MAX_ACCOUNTS - 1 );
+
+    return call_id >> ACCOUNT_BITS;
+}
+
+NAMESPACE_DIALER_END
@@ -0,0 +1,176 @@
+/*
+
+Multi-account dialer.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+// $Revision: 12038 $ $Date:: 2019-09-25 #$ $Author: serge $
+
+#ifndef LIB_DIALER_MULTI_DIALER_H
+#define LIB_DIALER_MULTI_DIALER_H
+
+#include <cstdint>                  // uint32_t
+#include <vector>                   // std::vector
+#include <string>                   // std::string
+#include <map>                      // std::map
+#include <memory>                   // std::unique_ptr
+#include <mutex>                    // std::mutex
+
+#include "../simple_voip/i_simple_voip.h"           // ISimpleVoip
+#include "../simple_voip/i_simple_voip_callback.h"  // ISimpleVoipCallback
+
+#include "dialer.h"                 // Dialer
+#include "call_outcome.h"           // IOutcomeCallback
+#include "stats.h"                  // Stats
+#include "dial_plan.h"              // DialPlan
+#include "route_limiter.h"          // RouteLimiter
+#include "aimd_limiter.h"           // AimdLimiter
+
+#include "namespace_lib.h"          // NAMESPACE_DIALER_START
+
+NAMESPACE_DIALER_START
+
+// Presents several Dialers, one per account, as one ISimpleVoip.
+// An InitiateCallRequest goes to an idle account (i.e. online and not reserved):
+// the cheapest one of its route in the dial plan, if the route names accounts,
+// otherwise one chosen by smooth weighted round-robin; the account is reserved
+// until the outcome of the request. Limits of the route are enforced by a RouteLimiter,
+// optionally the accounts and routes are throttled by AIMD limiters on infrastructure failures.
+// Call ids are made unique by encoding the account index, so call-scoped requests are routed
+// without lookup; calls of an account with an id above MAX_LOCAL_CALL_ID are hung up.
+class MultiDialer:
+        virtual public simple_voip::ISimpleVoip
+{
+public:
+    enum
+    {
+        ACCOUNT_BITS    = 4,
+        MAX_ACCOUNTS    = 1 << ACCOUNT_BITS
+    };
+
+    static const uint32_t MAX_LOCAL_CALL_ID = 0xFFFFFFFFu >> ACCOUNT_BITS;  // call id of an account that can be encoded
+
+public:
+    MultiDialer();
+    ~MultiDialer();
+
+    // dialer must be initialized, accounts are added before start
+    bool add_account( Dialer * dialer, uint32_t weight = 1 );
+
+    // must be called before the dialers of the accounts are started,
+    // the callbacks are read by their worker threads without lock
+    bool register_callback( simple_voip::ISimpleVoipCallback * callback );
+    bool register_outcome_callback( IOutcomeCallback * callback );
+
+    // also passed to all accounts, can be replaced at any time from any thread; nullptr - no plan
+    void set_dial_plan( const std::shared_ptr<const DialPlan> & plan );
+
+    // same, the limiter can be shared with other MultiDialers dialing by the same plan; nullptr - no limits
+    void set_dial_plan( const std::shared_ptr<const DialPlan> & plan, const std::shared_ptr<RouteLimiter> & limiter );
+
+    // accounts and routes are limited by outcomes: connected calls raise the limits,
+    // infrastructure failures (see is_infrastructure_failure) lower them; must be called before start
+    void enable_aimd( const AimdLimiter::Config & config );
+
+    // interface ISimpleVoip, can be called from any thread
+    virtual void consume( const simple_voip::ForwardObject * req );
+
+    uint32_t get_num_accounts() const;
+
+    // snapshots of all accounts at once, lock-free
+    void get_snapshots( std::vector<Dialer::Snapshot> * snapshots ) const;
+
+    const Stats & get_stats() const;
+
+    // current AIMD limits, max if not limited so far; 0 - no such account or route
+    double get_account_limit( uint32_t index ) const;
+    double get_route_limit( const std::string & prefix ) const;
+
+private:
+    // callbacks of one account
+    class AccountCallback:
+        virtual public simple_voip::ISimpleVoipCallback,
+        virtual public IOutcomeCallback
+    {
+    public:
+        AccountCallback( MultiDialer * parent, uint32_t index );
+
+        virtual void consume( const simple_voip::CallbackObject * obj );
+        virtual void on_call_outcome( const CallOutcome & outcome );
+
+    private:
+        MultiDialer     * parent_;
+        uint32_t        index_;
+    };
+
+    struct Account
+    {
+        Dialer                              * dialer;
+        uint32_t                            weight;
+        int32_t                             current_weight;     // smooth weighted round-robin
+        bool                                is_reserved;        // request routed, outcome not received yet
+        bool                                has_route;          // the request matched a route
+        std::string                         route;              // prefix of the route
+        std::shared_ptr<RouteLimiter>       limiter;            // holds a slot of the route, nullptr - none
+        AimdLimiter                         aimd;
+        std::unique_ptr<AccountCallback>    callback;
+    };
+
+private:
+    void route_initiate_call( const simple_voip::InitiateCallRequest * req );
+    void route_call_request( const simple_voip::ForwardObject * req );
+
+    int32_t select_account__( const DialPlan::Route * route, const AimdLimiter::time_point & now );
+    int32_t find_account__( const DialPlan::Route * route, const AimdLimiter::time_point & now, bool is_aimd_applied );
+    bool is_idle__( Account & a, const AimdLimiter::time_point & now, bool is_aimd_applied );
+    bool is_route_throttled__( const DialPlan::Route & route, const AimdLimiter::time_point & now );
+    double get_route_max_limit__( const DialPlan::Route & route ) const;
+    uint32_t get_num_reserved__() const;
+    uint32_t get_num_route_calls__( const std::string & prefix ) const;
+    void update_aimd__( Account & a, const CallOutcome & outcome );
+
+    void on_callback( uint32_t index, const simple_voip::CallbackObject * obj );
+    void on_call_outcome( uint32_t index, const CallOutcome & outcome );
+
+    void reject_initiate_call( const simple_voip::InitiateCallRequest * req, counter_e counter, uint32_t errorcode, const std::string & descr );
+    void send_reject_response( uint32_t req_id, uint32_t errorcode, const std::string & descr );
+
+    static uint32_t to_global_call_id( uint32_t index, uint32_t call_id );
+    static uint32_t to_local_call_id( uint32_t call_id, uint32_t * index );
+
+private:
+    mutable std::mutex                  mutex_;         // protects selection state of accounts
+
+    std::vector<Account>                accounts_;
+
+    std::shared_ptr<const DialPlan>     dial_plan_;
+    std::shared_ptr<RouteLimiter>       route_limiter_;
+
+    bool                                is_aimd_enabled_;
+    AimdLimiter::Config                 aimd_config_;
+    std::map<std::string,AimdLimiter>   route_aimd_;    // by route prefix, kept across plan reloads
+
+    simple_voip::ISimpleVoipCallback    * callback_;
+    std::vector<IOutcomeCallback*>      outcome_callbacks_; // both set before start, not protected by mutex_
+
+    Stats                               stats_;
+};
+
+NAMESPACE_DIALER_END
+
+#endif // LIB_DIALER_MULTI_DIALER_H
@@ -0,0 +1,187 @@
+/*
+
+Pacing controller.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+// $Revision: 12038 $ $Date:: 2019-09-25 #$ $Author: serge $
+
+#include "pacing_controller.h"      // self
+
+#include <cmath>                    // std::ceil
+
+#include "../utils/dummy_logger.h"  // dummy_log
+#include "../utils/mutex_helper.h"  // MUTEX_SCOPE_LOCK
+
+#include "campaign.h"               // Campaign
+
+#define MODULENAME      "PacingController"
+
+NAMESPACE_DIALER_START
+
+PacingController::PacingController():
+    campaign_( nullptr ),
+    capacity_( 0 ),
+    max_ratio_( 1.0 ),
+    min_samples_( 0 ),
+    concurrency_( 0 )
+{
+}
+
+bool PacingController::init(
+        uint32_t    capacity,
+        double      max_ratio,
+        double      alpha,
+        uint32_t    min_samples )
+{
+    MUTEX_SCOPE_LOCK( mutex_ );
+
+    if( capacity == 0 || max_ratio < 1.0 || alpha <= 0 || alpha > 1.0 )
+        return false;
+
+    capacity_       = capacity;
+    max_ratio_      = max_ratio;
+    min_samples_    = min_samples;
+
+    answer_rate_    = Ewma( alpha );
+    attempt_ms_     = Ewma( alpha );
+    talk_ms_        = Ewma( alpha );
+
+    update__();
+
+    dummy_log_info( MODULENAME, "init: capacity %u, max ratio %.2f, alpha %.3f", capacity, max_ratio, alpha );
+
+    return true;
+}
+
+void PacingController::set_campaign( Campaign * campaign )
+{
+    MUTEX_SCOPE_LOCK( mutex_ );
+
+    campaign_   = campaign;
+}
+
+void PacingController::set_capacity( uint32_t capacity )
+{
+    Campaign * campaign;
+
+    {
+        MUTEX_SCOPE_LOCK( mutex_ );
+
+        capacity_   = capacity;
+
+        update__();
+
+        campaign    = campaign_;
+    }
+
+    if( campaign )
+        campaign->set_concurrency( concurrency_ );
+}
+
+void PacingController::on_call_outcome( const CallOutcome & outcome )
+{
+    // called by the worker thread of the dialer
+
+    // no line was used
+    if( outcome.result == call_result_e::REJECTED || outcome.result == call_result_e::BLOCKED )
+        return;
+
+    Campaign * campaign;
+
+    {
+        MUTEX_SCOPE_LOCK( mutex_ );
+
+        bool is_answered_call = is_answered( outcome );
+
+        answer_rate_.add( is_answered_call ? 1.0 : 0.0 );
+
+        // a voicemail holds the line until it is dropped, like a long ringing
+        if( outcome.result == call_result_e::VOICEMAIL )
+            attempt_ms_.add( outcome.post_dial_ms + outcome.ring_ms + outcome.talk_ms );
+        else
+            attempt_ms_.add( outcome.post_dial_ms + outcome.ring_ms );
+
+        if( is_answered_call )
+            talk_ms_.add( outcome.talk_ms );
+
+        update__();
+
+        campaign    = campaign_;
+    }
+
+    if( campaign )
+        campaign->set_concurrency( concurrency_ );
+}
+
+uint32_t PacingController::get_concurrency() const
+{
+    return concurrency_.load( std::memory_order_relaxed );
+}
+
+PacingController::Estimates PacingController::get_estimates() const
+{
+    MUTEX_SCOPE_LOCK( mutex_ );
+
+    Estimates res = { answer_rate_.get(), attempt_ms_.get(), talk_ms_.get(), answer_rate_.get_num_samples() };
+
+    return res;
+}
+
+void PacingController::update__()
+{
+    // private: no mutex lock
+
+    double max_lines    = capacity_ * max_ratio_;
+    double lines        = capacity_;
+
+    if( answer_rate_.get_num_samples() >= min_samples_ && talk_ms_.get_num_samples() > 0 )
+    {
+        double busy = answer_rate_.get() * talk_ms_.get();
+
+        lines = ( busy > 0 ) ? capacity_ * ( 1.0 + attempt_ms_.get() / busy ) : max_lines;
+    }
+    else if( answer_rate_.get_num_samples() >= min_samples_ )
+    {
+        // nothing answered so far
+        lines = max_lines;
+    }
+
+    if( lines > max_lines )
+        lines = max_lines;
+
+    uint32_t concurrency = static_cast<uint32_t>( std::ceil( lines ) );
+
+    if( concurrency != concurrency_ )
+        dummy_log_debug( MODULENAME, "concurrency %u -> %u, answer rate %.3f, attempt %.0f ms, talk %.0f ms",
+                concurrency_.load(), concurrency, answer_rate_.get(), attempt_ms_.get(), talk_ms_.get() );
+
+    concurrency_    = concurrency;
+}
+
+bool PacingController::is_answered( const CallOutcome & outcome )
+{
+    if( outcome.result == call_result_e::VOICEMAIL )
+        return false;
+
+    return outcome.talk_ms > 0 ||
+            outcome.result == call_result_e::COMPLETED ||
+            outcome.result == call_result_e::CONNECTION_LOST;
+}
+
+NAMESPACE_DIALER_END
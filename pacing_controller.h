@@ -0,0 +1,105 @@
+/*
+
+Pacing controller.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+// $Revision: 12038 $ $Date:: 2019-09-25 #$ $Author: serge $
+
+#ifndef LIB_DIALER_PACING_CONTROLLER_H
+#define LIB_DIALER_PACING_CONTROLLER_H
+
+#include <cstdint>                  // uint32_t
+#include <mutex>                    // std::mutex
+#include <atomic>                   // std::atomic
+
+#include "call_outcome.h"           // IOutcomeCallback
+#include "ewma.h"                   // Ewma
+
+#include "namespace_lib.h"          // NAMESPACE_DIALER_START
+
+NAMESPACE_DIALER_START
+
+class Campaign;
+
+// Predicts how many calls to keep in flight, so that the answered ones match the capacity
+// (agents or IVR ports). A line spends on average D (post-dial + ring) per attempt
+// and p * T talking, so capacity / lines = p * T / ( D + p * T ).
+// Answer rate p, talk time T and attempt time D are estimated from the outcomes.
+// With a campaign set, its concurrency is updated on each outcome; the controller must be
+// registered as outcome callback before the campaign, to be applied to the next call.
+// The campaign needs at least capacity * max_ratio req ids, its concurrency is clamped to them.
+class PacingController:
+        virtual public IOutcomeCallback
+{
+public:
+    struct Estimates
+    {
+        double      answer_rate;
+        double      attempt_ms;     // post-dial and ring time
+        double      talk_ms;        // of answered calls
+        uint32_t    num_samples;
+    };
+
+public:
+    PacingController();
+
+    // max_ratio - limit of the lines per unit of capacity, min_samples - dial 1:1 until seen
+    bool init(
+            uint32_t    capacity,
+            double      max_ratio   = 3.0,
+            double      alpha       = 0.05,
+            uint32_t    min_samples = 20 );
+
+    void set_campaign( Campaign * campaign );
+
+    // can be called from any thread
+    void set_capacity( uint32_t capacity );
+
+    // interface IOutcomeCallback
+    virtual void on_call_outcome( const CallOutcome & outcome );
+
+    // lock-free
+    uint32_t get_concurrency() const;
+
+    Estimates get_estimates() const;
+
+private:
+    void update__();
+
+    static bool is_answered( const CallOutcome & outcome );
+
+private:
+    mutable std::mutex      mutex_;
+
+    Campaign                * campaign_;
+
+    uint32_t                capacity_;
+    double                  max_ratio_;
+    uint32_t                min_samples_;
+
+    Ewma                    answer_rate_;
+    Ewma                    attempt_ms_;
+    Ewma                    talk_ms_;
+
+    std::atomic<uint32_t>   concurrency_;
+};
+
+NAMESPACE_DIALER_END
+
+#endif // LIB_DIALER_PACING_CONTROLLER_H
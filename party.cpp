@@ -0,0 +1,142 @@
+/*
+
+Party grammar.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+// $Revision: 12038 $ $Date:: 2019-09-25 #$ $Author: serge $
+
+#include "party.h"                  // self
+
+#ifdef __SSE2__
+#include <emmintrin.h>              // _mm_loadu_si128
+#endif
+
+NAMESPACE_DIALER_START
+
+bool is_all_digits( const char * s, size_t len )
+{
+    size_t i = 0;
+
+#ifdef __SSE2__
+    // a byte is a digit if ( c - '0' ) as unsigned is below 10,
+    // with signed compares: ( c - '0' - 128 ) < ( 10 - 128 )
+    const __m128i offset    = _mm_set1_epi8( static_cast<char>( '0' + 128 ) );
+    const __m128i limit     = _mm_set1_epi8( static_cast<char>( 10 - 128 ) );
+
+    for( ; i + 16 <= len; i += 16 )
+    {
+        __m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i*>( s + i ) );
+
+        __m128i d = _mm_cmplt_epi8( _mm_sub_epi8( v, offset ), limit );
+
+        if( _mm_movemask_epi8( d ) != 0xFFFF )
+            return false;
+    }
+#endif
+
+    for( ; i < len; ++i )
+    {
+        if( s[i] < '0' || s[i] > '9' )
+            return false;
+    }
+
+    return true;
+}
+
+static bool is_alpha( char c )
+{
+    return ( c >= 'a' && c <= 'z' ) || ( c >= 'A' && c <= 'Z' );
+}
+
+party_e get_party_type( const char * s, size_t len )
+{
+    if( len >= 2 && s[0] == '+' && s[1] >= '1' && s[1] <= '9' && is_all_digits( s + 2, len - 2 ) )
+        return party_e::NUMBER;
+
+    if( len >= 1 && is_alpha( s[0] ) )
+    {
+        for( size_t i = 1; i < len; ++i )
+        {
+            char c = s[i];
+
+            if( is_alpha( c ) == false && ( c < '0' || c > '9' ) && c != '_' )
+                return party_e::UNKNOWN;
+        }
+
+        return party_e::SYMBOLIC;
+    }
+
+    return party_e::UNKNOWN;
+}
+
+party_e get_party_type( const std::string & s )
+{
+    return get_party_type( s.data(), s.size() );
+}
+
+bool transform_party( const std::string & inp, std::string & outp )
+{
+    auto party_type = get_party_type( inp );
+
+    if( party_type == party_e::NUMBER )
+    {
+        outp = "00" + inp.substr( 1 );
+        return true;
+    }
+
+    if( party_type == party_e::SYMBOLIC )
+    {
+        outp = inp;
+        return true;
+    }
+
+    return false;
+}
+
+bool normalize_party( const char * s, size_t len, std::string * outp )
+{
+    while( len > 0 && ( s[0] == ' ' || s[0] == '\t' ) )
+    {
+        ++s;
+        --len;
+    }
+
+    while( len > 0 && ( s[len - 1] == ' ' || s[len - 1] == '\t' || s[len - 1] == '\r' ) )
+        --len;
+
+    if( len >= 3 && s[0] == '0' && s[1] == '0' )
+    {
+        if( s[2] < '1' || s[2] > '9' || is_all_digits( s + 3, len - 3 ) == false )
+            return false;
+
+        outp->assign( 1, '+' );
+        outp->append( s + 2, len - 2 );
+
+        return true;
+    }
+
+    if( get_party_type( s, len ) == party_e::UNKNOWN )
+        return false;
+
+    outp->assign( s, len );
+
+    return true;
+}
+
+NAMESPACE_DIALER_END
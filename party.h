@@ -0,0 +1,56 @@
+/*
+
+Party grammar.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+// $Revision: 12038 $ $Date:: 2019-09-25 #$ $Author: serge $
+
+#ifndef LIB_DIALER_PARTY_H
+#define LIB_DIALER_PARTY_H
+
+#include <cstddef>                  // size_t
+#include <string>                   // std::string
+
+#include "namespace_lib.h"          // NAMESPACE_DIALER_START
+
+NAMESPACE_DIALER_START
+
+enum class party_e
+{
+    UNKNOWN,
+    NUMBER,         // ^\+[1-9][0-9]*$
+    SYMBOLIC        // ^[a-zA-Z][a-zA-Z0-9_]*$
+};
+
+party_e get_party_type( const char * s, size_t len );
+party_e get_party_type( const std::string & s );
+
+// into the form expected by the voip service: numbers with "00" instead of "+"
+bool transform_party( const std::string & inp, std::string & outp );
+
+// party from a dial list into the form of InitiateCallRequest:
+// surrounding blanks are removed, a leading "00" is replaced by "+"
+bool normalize_party( const char * s, size_t len, std::string * outp );
+
+// vectorized where SSE2 is available
+bool is_all_digits( const char * s, size_t len );
+
+NAMESPACE_DIALER_END
+
+#endif // LIB_DIALER_PARTY_H
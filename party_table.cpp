@@ -0,0 +1,82 @@
+/*
+
+Party table.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+// $Revision: 12038 $ $Date:: 2019-09-25 #$ $Author: serge $
+
+#include "party_table.h"            // self
+
+#include "phone_number.h"           // PhoneNumber
+
+NAMESPACE_DIALER_START
+
+uint64_t PartyTable::add( const std::string & party )
+{
+    PhoneNumber number;
+
+    if( PhoneNumber::parse( party, & number ) )
+        return number.get_value();
+
+    uint32_t idx;
+
+    if( free_.empty() == false )
+    {
+        idx = free_.back();
+        free_.pop_back();
+
+        symbolic_[ idx ]    = party;
+    }
+    else
+    {
+        idx = symbolic_.size();
+
+        symbolic_.push_back( party );
+    }
+
+    return SYMBOLIC_FLAG | idx;
+}
+
+std::string PartyTable::get( uint64_t key ) const
+{
+    if( ( key & SYMBOLIC_FLAG ) == 0 )
+        return PhoneNumber::from_value( key ).to_string();
+
+    return symbolic_[ static_cast<uint32_t>( key & ~SYMBOLIC_FLAG ) ];
+}
+
+void PartyTable::release( uint64_t key )
+{
+    if( ( key & SYMBOLIC_FLAG ) == 0 )
+        return;
+
+    uint32_t idx = static_cast<uint32_t>( key & ~SYMBOLIC_FLAG );
+
+    std::string().swap( symbolic_[ idx ] );
+
+    free_.push_back( idx );
+}
+
+uint32_t PartyTable::get_num_symbolic() const
+{
+    return symbolic_.size() - free_.size();
+}
+
+NAMESPACE_DIALER_END
@@ -0,0 +1,61 @@
+/*
+
+Party table.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+// $Revision: 12038 $ $Date:: 2019-09-25 #$ $Author: serge $
+
+#ifndef LIB_DIALER_PARTY_TABLE_H
+#define LIB_DIALER_PARTY_TABLE_H
+
+#include <cstdint>                  // uint64_t
+#include <string>                   // std::string
+#include <vector>                   // std::vector
+
+#include "namespace_lib.h"          // NAMESPACE_DIALER_START
+
+NAMESPACE_DIALER_START
+
+// Parties as 64-bit keys, so large queues of them stay small: a number is its PhoneNumber value,
+// any other party is stored in the table until released and keyed by its slot.
+// Not thread-safe, the owner locks.
+class PartyTable
+{
+public:
+    uint64_t add( const std::string & party );
+
+    std::string get( uint64_t key ) const;
+
+    // frees the slot of a symbolic party, numbers need no release
+    void release( uint64_t key );
+
+    uint32_t get_num_symbolic() const;
+
+private:
+    static const uint64_t SYMBOLIC_FLAG = 1ull << 63;
+
+private:
+    std::vector<std::string>    symbolic_;      // parties which are not numbers
+    std::vector<uint32_t>       free_;          // free slots of symbolic_
+};
+
+NAMESPACE_DIALER_END
+
+#endif // LIB_DIALER_PARTY_TABLE_H
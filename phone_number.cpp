@@ -0,0 +1,100 @@
+/*
+
+Phone number.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+// $Revision: 12038 $ $Date:: 2019-09-25 #$ $Author: serge $
+
+#include "phone_number.h"           // self
+
+#include "../utils/utils_assert.h"  // ASSERT
+
+NAMESPACE_DIALER_START
+
+bool PhoneNumber::parse( const char * s, size_t len, PhoneNumber * number )
+{
+    if( len < 2 || len > MAX_DIGITS + 1 || s[0] != '+' || s[1] == '0' )
+        return false;
+
+    uint64_t res = 0;
+
+    for( size_t i = 1; i < len; ++i )
+    {
+        uint32_t d = static_cast<unsigned char>( s[i] ) - '0';
+
+        if( d > 9 )
+            return false;
+
+        res = res * 10 + d;
+    }
+
+    number->value_  = res;
+
+    return true;
+}
+
+bool PhoneNumber::parse( const std::string & s, PhoneNumber * number )
+{
+    return parse( s.c_str(), s.size(), number );
+}
+
+PhoneNumber PhoneNumber::from_value( uint64_t value )
+{
+    PhoneNumber res;
+
+    res.value_  = value;
+
+    return res;
+}
+
+uint32_t PhoneNumber::format_digits( char * buf ) const
+{
+    ASSERT( is_valid() );
+
+    uint32_t n = 0;
+
+    for( uint64_t v = value_; v > 0; v /= 10 )
+        ++n;
+
+    uint64_t v = value_;
+
+    for( uint32_t i = n; i > 0; --i, v /= 10 )
+        buf[ i - 1 ] = static_cast<char>( '0' + v % 10 );
+
+    return n;
+}
+
+std::string PhoneNumber::get_digits() const
+{
+    char buf[ MAX_DIGITS ];
+
+    return std::string( buf, format_digits( buf ) );
+}
+
+std::string PhoneNumber::to_string() const
+{
+    char buf[ MAX_DIGITS + 1 ];
+
+    buf[0]  = '+';
+
+    return std::string( buf, format_digits( buf + 1 ) + 1 );
+}
+
+NAMESPACE_DIALER_END
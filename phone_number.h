@@ -0,0 +1,96 @@
+/*
+
+Phone number.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+// $Revision: 12038 $ $Date:: 2019-09-25 #$ $Author: serge $
+
+#ifndef LIB_DIALER_PHONE_NUMBER_H
+#define LIB_DIALER_PHONE_NUMBER_H
+
+#include <cstddef>                  // size_t
+#include <cstdint>                  // uint64_t
+#include <string>                   // std::string
+
+#include "namespace_lib.h"          // NAMESPACE_DIALER_START
+
+NAMESPACE_DIALER_START
+
+// A NUMBER party ("+" and digits, see party_e) packed into one integer.
+// The first digit is never 0, so the digits map to the value one to one;
+// up to 18 digits fit, E.164 needs 15.
+class PhoneNumber
+{
+public:
+    enum
+    {
+        MAX_DIGITS  = 18
+    };
+
+public:
+    // invalid
+    PhoneNumber():
+        value_( 0 )
+    {
+    }
+
+    // false if the party is not a number or too long, number is not changed then
+    static bool parse( const char * s, size_t len, PhoneNumber * number );
+    static bool parse( const std::string & s, PhoneNumber * number );
+
+    // value of a valid number, e.g. read from a file
+    static PhoneNumber from_value( uint64_t value );
+
+    bool is_valid() const
+    {
+        return value_ != 0;
+    }
+
+    // digits as integer, 0 - invalid
+    uint64_t get_value() const
+    {
+        return value_;
+    }
+
+    // digits without "+" into buf of MAX_DIGITS chars, returns the number of digits
+    uint32_t format_digits( char * buf ) const;
+
+    std::string get_digits() const;
+
+    // with "+"
+    std::string to_string() const;
+
+    bool operator==( const PhoneNumber & r ) const
+    {
+        return value_ == r.value_;
+    }
+
+    bool operator<( const PhoneNumber & r ) const
+    {
+        return value_ < r.value_;
+    }
+
+private:
+    uint64_t    value_;
+};
+
+NAMESPACE_DIALER_END
+
+#endif // LIB_DIALER_PHONE_NUMBER_H
@@ -23,48 +23,49 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 
 #include "player_sm.h"              // self
 
-#include <functional>                   // std::bind
-
 #include "../simple_voip/i_simple_voip.h"  // IVoipService
 #include "../simple_voip/i_simple_voip_callback.h" // ISimpleVoipCallback
 #include "../skype_service/skype_service.h"     // skype_service::SkypeService
-#include "../simple_voip/object_factory.h"  // simple_voip::create_play_file
 #include "../utils/dummy_logger.h"      // dummy_log
-#include "../utils/mutex_helper.h"      // MUTEX_SCOPE_LOCK
 #include "../utils/utils_assert.h"            // ASSERT
 #include "str_helper.h"                 // StrHelper
 
-#include "../scheduler/i_scheduler.h"       // IScheduler
-#include "../scheduler/timeout_job_aux.h"   // create_timeout_job
-
 #include "namespace_lib.h"          // NAMESPACE_DIALER_START
 
 #define MODULENAME      "PlayerSM"
 
-#define PLAY_TIMEOUT    ( 2 )
+#define PLAY_TIMEOUT_MS     ( 2000 )
+
+#ifndef NDEBUG
+#define ASSERT_THREAD_AFFINITY()    assert_thread_affinity()
+#else
+#define ASSERT_THREAD_AFFINITY()
+#endif
 
 NAMESPACE_DIALER_START
 
 PlayerSM::PlayerSM():
-    state_( IDLE ), req_id_( 0 ), sio_( 0L ), sched_( 0L ), callback_( nullptr ), job_id_( 0 )
+    state_( IDLE ), req_id_( 0 ), sio_( 0L ), timers_( 0L ), pool_( 0L ), dispatcher_( 0L ), timer_id_( 0 )
 {
 }
 
 PlayerSM::~PlayerSM()
 {
-//    if( job_id_ )
-//    {
-//        delete job_id_;
-//    }
 }
 
-bool PlayerSM::init( skype_service::SkypeService * sw, scheduler::IScheduler * sched )
+bool PlayerSM::init(
+        skype_service::SkypeService * sw,
+        TimerWheel                  * timers,
+        CallbackObjectPool          * pool,
+        CallbackDispatcher          * dispatcher )
 {
-    if( !sw || !sched )
+    if( !sw || !timers || !pool || !dispatcher )
         return false;
 
-    sio_    = sw;
-    sched_  = sched;
+    sio_        = sw;
+    timers_     = timers;
+    pool_       = pool;
+    dispatcher_ = dispatcher;
 
     dummy_log_info( MODULENAME, "init: switching to IDLE" );
 
@@ -74,42 +75,31 @@ bool PlayerSM::init( skype_service::SkypeService * sw, scheduler::IScheduler * s
     return true;
 }
 
-
-bool PlayerSM::register_callback( simple_voip::ISimpleVoipCallback  * callback )
+bool PlayerSM::is_inited() const
 {
-    if( callback == 0L )
+    if( !sio_ || timers_ == 0L )
         return false;
 
-    MUTEX_SCOPE_LOCK( mutex_ );
-
-    if( callback_ != 0L )
-        return false;
-
-    callback_ = callback;
-
     return true;
 }
 
-bool PlayerSM::is_inited() const
+PlayerSM::state_e PlayerSM::get_state() const
 {
-    if( !sio_ || sched_ == 0L )
-        return false;
-
-    return true;
+    return state_;
 }
 
 
-void PlayerSM::play_file( uint32_t req_id, uint32_t call_id, const std::string & filename )
+bool PlayerSM::play_file( uint32_t req_id, uint32_t call_id, const std::string & filename )
 {
     dummy_log_debug( MODULENAME, "play_file: req_id %u", req_id );
 
-    MUTEX_SCOPE_LOCK( mutex_ );
+    ASSERT_THREAD_AFFINITY();
 
     if( state_ != IDLE )
     {
         dummy_log_fatal( MODULENAME, "play_file: unexpected in state %s", StrHelper::to_string( state_ ).c_str() );
         ASSERT( false );
-        return;
+        return false;
     }
 
     ASSERT( is_inited() );
@@ -120,9 +110,9 @@ void PlayerSM::play_file( uint32_t req_id, uint32_t call_id, const std::string &
     {
         dummy_log_error( MODULENAME, "failed setting input file: %s", filename.c_str() );
 
-        callback_->consume( simple_voip::create_error_response( req_id, 0, "failed setting input file: " + filename ) );
+        CALLBACK_SEND( * dispatcher_, pool_->create_error_response( req_id, 0, "failed setting input file: " + filename ) );
 
-        return;
+        return false;
     }
 
     ASSERT( req_id_ == 0 );
@@ -130,13 +120,15 @@ void PlayerSM::play_file( uint32_t req_id, uint32_t call_id, const std::string &
     req_id_ = req_id;
 
     next_state( WAIT_PLAY_RESP );
+
+    return true;
 }
 
-void PlayerSM::stop( uint32_t req_id, uint32_t call_id )
+bool PlayerSM::stop( uint32_t req_id, uint32_t call_id )
 {
     dummy_log_debug( MODULENAME, "stop: req_id %u", req_id );
 
-    MUTEX_SCOPE_LOCK( mutex_ );
+    ASSERT_THREAD_AFFINITY();
 
     switch( state_ )
     {
@@ -148,16 +140,15 @@ void PlayerSM::stop( uint32_t req_id, uint32_t call_id )
 
     case WAIT_PLAY_START:
     {
-        if( job_id_ )
+        if( timer_id_ )
         {
-            std::string error_msg;
-            sched_->delete_job( & error_msg, job_id_ );     // cancel timeout job as replay was successfully started
-            job_id_     = 0;
+            timers_->cancel( timer_id_ );
+            timer_id_   = 0;
         }
 
         dummy_log_debug( MODULENAME, "stop: ok" );
 
-        callback_->consume( simple_voip::create_play_file_stop_response( req_id ) );
+        CALLBACK_SEND( * dispatcher_, pool_->create_play_file_stop_response( req_id ) );
 
         req_id_     = 0;
         next_state( IDLE );
@@ -168,7 +159,7 @@ void PlayerSM::stop( uint32_t req_id, uint32_t call_id )
     {
         dummy_log_debug( MODULENAME, "stop: ok" );
 
-        callback_->consume( simple_voip::create_play_file_stop_response( req_id ) );
+        CALLBACK_SEND( * dispatcher_, pool_->create_play_file_stop_response( req_id ) );
 
         req_id_     = 0;
         next_state( IDLE );
@@ -183,9 +174,9 @@ void PlayerSM::stop( uint32_t req_id, uint32_t call_id )
         {
             dummy_log_error( MODULENAME, "failed input soundcard" );
 
-            callback_->consume( simple_voip::create_error_response( req_id, 0, "failed setting input soundcard" ) );
+            CALLBACK_SEND( * dispatcher_, pool_->create_error_response( req_id, 0, "failed setting input soundcard" ) );
 
-            return;
+            return false;
         }
 
         ASSERT( req_id_ == 0 );
@@ -193,6 +184,8 @@ void PlayerSM::stop( uint32_t req_id, uint32_t call_id )
         req_id_ = req_id;
 
         next_state( CANCELED_IN_P );
+
+        return true;
     }
     break;
 
@@ -203,13 +196,15 @@ void PlayerSM::stop( uint32_t req_id, uint32_t call_id )
     }
 
     ASSERT( is_inited() );
+
+    return false;
 }
 
 void PlayerSM::on_loss()
 {
     dummy_log_debug( MODULENAME, "on_loss" );
 
-    MUTEX_SCOPE_LOCK( mutex_ );
+    ASSERT_THREAD_AFFINITY();
 
     if( state_ == IDLE )
     {
@@ -219,11 +214,10 @@ void PlayerSM::on_loss()
 
     if( state_ == WAIT_PLAY_START )
     {
-        if( job_id_ )
+        if( timer_id_ )
         {
-            std::string error_msg;
-            sched_->delete_job( & error_msg, job_id_ );     // cancel timeout job as replay was successfully started
-            job_id_     = 0;
+            timers_->cancel( timer_id_ );
+            timer_id_   = 0;
         }
     }
 
@@ -239,7 +233,7 @@ void PlayerSM::on_play_file_response( uint32_t req_id )
 {
     dummy_log_debug( MODULENAME, "on_play_file_response: req_id %u", req_id );
 
-    MUTEX_SCOPE_LOCK( mutex_ );
+    ASSERT_THREAD_AFFINITY();
 
     if( state_ != WAIT_PLAY_RESP )
     {
@@ -250,31 +244,51 @@ void PlayerSM::on_play_file_response( uint32_t req_id )
 
     dummy_log_debug( MODULENAME, "on_play_file_response: ok" );
 
-    if( job_id_ )
+    if( timer_id_ )
     {
-        std::string error_msg;
-        sched_->delete_job( & error_msg, job_id_ );     // cancel timeout job as replay was successfully started
-        job_id_     = 0;
+        timers_->cancel( timer_id_ );
+        timer_id_   = 0;
     }
 
-    std::string err_msg;
-    scheduler::create_and_insert_timeout_job( & job_id_, & err_msg, * sched_, "timeout", PLAY_TIMEOUT, std::bind( &PlayerSM::on_play_failed, this, req_id ) );
+    timer_id_   = timers_->insert( PLAY_TIMEOUT_MS, [this, req_id]() { on_play_failed( req_id ); } );
 
     req_id_ = req_id;
     next_state( WAIT_PLAY_START );
 }
 
-void PlayerSM::on_error_response( uint32_t req_id )
+void PlayerSM::on_error_response( uint32_t req_id, uint32_t errorcode, const std::string & descr )
 {
     dummy_log_debug( MODULENAME, "on_error_response: %u", req_id );
 
-    MUTEX_SCOPE_LOCK( mutex_ );
+    ASSERT_THREAD_AFFINITY();
 
-    if( state_ != WAIT_PLAY_RESP )
+    switch( state_ )
     {
-        dummy_log_fatal( MODULENAME, "on_play_file_response: unexpected in state %s", StrHelper::to_string( state_ ).c_str() );
+    case WAIT_PLAY_RESP:
+    {
+        CALLBACK_SEND( * dispatcher_, pool_->create_error_response( req_id, errorcode, descr ) );
+
+        req_id_ = 0;
+        next_state( IDLE );
+    }
+        break;
+
+    case CANCELED_IN_P:
+    {
+        // the stop failed, the playback goes on
+        ASSERT( req_id == req_id_ );
+
+        CALLBACK_SEND( * dispatcher_, pool_->create_error_response( req_id, errorcode, descr ) );
+
+        req_id_ = 0;
+        next_state( PLAYING );
+    }
+        break;
+
+    default:
+        dummy_log_fatal( MODULENAME, "on_error_response: unexpected in state %s", StrHelper::to_string( state_ ).c_str() );
         ASSERT( false );
-        return;
+        break;
     }
 }
 
@@ -282,7 +296,7 @@ void PlayerSM::on_play_start( uint32_t call_id )
 {
     dummy_log_debug( MODULENAME, "on_play_start: %u", call_id );
 
-    MUTEX_SCOPE_LOCK( mutex_ );
+    ASSERT_THREAD_AFFINITY();
 
     if( state_ != WAIT_PLAY_START )
     {
@@ -293,11 +307,10 @@ void PlayerSM::on_play_start( uint32_t call_id )
 
     dummy_log_debug( MODULENAME, "on_play_start: ok" );
 
-    callback_->consume( simple_voip::create_play_file_response( req_id_ ) );
+    CALLBACK_SEND( * dispatcher_, pool_->create_play_file_response( req_id_ ) );
 
-    std::string error_msg;
-    sched_->delete_job( & error_msg, job_id_ );     // cancel timeout job as replay was successfully started
-    job_id_     = 0;
+    timers_->cancel( timer_id_ );       // cancel timeout as replay was successfully started
+    timer_id_   = 0;
     req_id_ = 0;
     next_state( PLAYING );
 }
@@ -306,7 +319,7 @@ void PlayerSM::on_play_stop( uint32_t call_id )
 {
     dummy_log_debug( MODULENAME, "on_play_stop: %u", call_id );
 
-    MUTEX_SCOPE_LOCK( mutex_ );
+    ASSERT_THREAD_AFFINITY();
 
     switch( state_ )
     {
@@ -321,7 +334,7 @@ void PlayerSM::on_play_stop( uint32_t call_id )
     {
         ASSERT( req_id_ );
 
-        callback_->consume( simple_voip::create_play_file_stop_response( req_id_ ) );
+        CALLBACK_SEND( * dispatcher_, pool_->create_play_file_stop_response( req_id_ ) );
 
         dummy_log_debug( MODULENAME, "on_play_stop: ok" );
 
@@ -341,7 +354,7 @@ void PlayerSM::on_play_failed( uint32_t req_id )
 {
     dummy_log_debug( MODULENAME, "on_play_failed: req_id %u", req_id );
 
-    MUTEX_SCOPE_LOCK( mutex_ );
+    ASSERT_THREAD_AFFINITY();
 
     if( state_ != WAIT_PLAY_START )
     {
@@ -352,9 +365,9 @@ void PlayerSM::on_play_failed( uint32_t req_id )
 
     dummy_log_debug( MODULENAME, "on_play_failed: ok" );
 
-    callback_->consume( simple_voip::create_error_response( req_id_, 0, "play failed" ) );
+    CALLBACK_SEND( * dispatcher_, pool_->create_error_response( req_id_, 0, "play failed" ) );
 
-    job_id_     = 0;       // job_id_ is not valid after call of invoke()
+    timer_id_   = 0;       // timer_id_ is not valid after the timer has fired
     req_id_ = 0;
     next_state( IDLE );
 }
@@ -371,4 +384,15 @@ void PlayerSM::trace_state_switch() const
     dummy_log_debug( MODULENAME, "switched to %s", StrHelper::to_string( state_ ).c_str() );
 }
 
+void PlayerSM::assert_thread_affinity()
+{
+    if( owner_ == std::thread::id() )
+    {
+        owner_  = std::this_thread::get_id();
+        return;
+    }
+
+    ASSERT( owner_ == std::this_thread::get_id() );
+}
+
 NAMESPACE_DIALER_END
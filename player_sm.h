@@ -27,29 +27,22 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 #include <string>                   // std::string
 #include <cstdint>                  // uint32_t
 
-#include <mutex>                    // std::mutex
+#include <thread>                   // std::thread::id
 #include "namespace_lib.h"          // NAMESPACE_DIALER_START
 
-#include "../scheduler/job_id_t.h"  // job_id_t
-
-namespace scheduler
-{
-class IScheduler;
-class IOneTimeJob;
-}
+#include "timer_wheel.h"            // TimerWheel
+#include "callback_object_pool.h"   // CallbackObjectPool
+#include "callback_dispatcher.h"    // CallbackDispatcher
 
 namespace skype_service
 {
 class SkypeService;
 }
 
-namespace simple_voip
-{
-class ISimpleVoipCallback;
-}
-
 NAMESPACE_DIALER_START
 
+// Not thread-safe: confined to the thread of the Dialer worker,
+// the play timeout is fired by the timer wheel on the same thread.
 class PlayerSM
 {
 public:
@@ -68,24 +61,28 @@ public:
     PlayerSM();
     ~PlayerSM();
 
-    bool init( skype_service::SkypeService * sw, scheduler::IScheduler * scheduler );
-
-    bool register_callback( simple_voip::ISimpleVoipCallback  * callback );
+    bool init(
+            skype_service::SkypeService * sw,
+            TimerWheel                  * timers,
+            CallbackObjectPool          * pool,
+            CallbackDispatcher          * dispatcher );
 
     bool is_inited() const;
 
-    // IPlayerSM
-    void play_file( uint32_t req_id, uint32_t call_id, const std::string & filename );
-    void stop( uint32_t req_id, uint32_t call_id );
+    state_e get_state() const;
+
+    // IPlayerSM, return true if the request was sent and a response is awaited
+    bool play_file( uint32_t req_id, uint32_t call_id, const std::string & filename );
+    bool stop( uint32_t req_id, uint32_t call_id );
     void on_loss();
 
     // ISimpleVoipCallback
     void on_play_file_response( uint32_t req_id );
-    void on_error_response( uint32_t req_id );
+    void on_error_response( uint32_t req_id, uint32_t errorcode, const std::string & descr );
     void on_play_start( uint32_t call_id );
     void on_play_stop( uint32_t call_id );
 
-    // called by timer
+    // called by timer wheel
     void on_play_failed( uint32_t req_id );
 
 private:
@@ -93,18 +90,20 @@ private:
     void next_state( state_e state );
     void trace_state_switch() const;
 
+    void assert_thread_affinity();
+
 private:
-    mutable std::mutex          mutex_;
+    std::thread::id             owner_;     // bound on the first call
 
     state_e                     state_;
     uint32_t                    req_id_;
 
     skype_service::SkypeService * sio_;
-    scheduler::IScheduler       * sched_;
-    simple_voip::ISimpleVoipCallback  * callback_;
+    TimerWheel                  * timers_;
+    CallbackObjectPool          * pool_;
+    CallbackDispatcher          * dispatcher_;
 
-    //std::shared_ptr<scheduler::IOneTimeJob>     job_id_;
-    scheduler::job_id_t         job_id_;
+    TimerWheel::timer_id_t      timer_id_;
 };
 
 NAMESPACE_DIALER_END
@@ -0,0 +1,245 @@
+/*
+
+Redial scheduler.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+// $Revision: 12038 $ $Date:: 2019-09-25 #$ $Author: serge $
+
+#include "redial_scheduler.h"       // self
+
+#include <algorithm>                // std::push_heap
+#include <cmath>                    // std::pow
+
+#include "../utils/dummy_logger.h"  // dummy_log
+#include "../utils/mutex_helper.h"  // MUTEX_SCOPE_LOCK
+
+#include "campaign.h"               // Campaign
+#include "str_helper.h"             // StrHelper
+
+#define MODULENAME      "RedialScheduler"
+
+NAMESPACE_DIALER_START
+
+RedialScheduler::RedialScheduler():
+    campaign_( nullptr ),
+    max_attempts_( 0 ),
+    tick_ms_( 0 ),
+    must_stop_( false ),
+    num_pending_( 0 ),
+    num_in_transit_( 0 ),
+    num_scheduled_( 0 ),
+    num_released_( 0 ),
+    num_exhausted_( 0 )
+{
+}
+
+RedialScheduler::~RedialScheduler()
+{
+    shutdown();
+}
+
+bool RedialScheduler::init( Campaign * campaign, uint32_t max_attempts, uint32_t tick_ms )
+{
+    MUTEX_SCOPE_LOCK( mutex_ );
+
+    if( campaign == nullptr || max_attempts == 0 || tick_ms == 0 )
+        return false;
+
+    campaign_       = campaign;
+    max_attempts_   = max_attempts;
+    tick_ms_        = tick_ms;
+    epoch_          = std::chrono::steady_clock::now();
+
+    dummy_log_info( MODULENAME, "init: max attempts %u, tick %u ms", max_attempts, tick_ms );
+
+    return true;
+}
+
+void RedialScheduler::set_policy( call_result_e result, const Policy & policy )
+{
+    MUTEX_SCOPE_LOCK( mutex_ );
+
+    result_policies_[ result ]  = policy;
+}
+
+void RedialScheduler::set_policy( failure_reason_e reason, const Policy & policy )
+{
+    MUTEX_SCOPE_LOCK( mutex_ );
+
+    reason_policies_[ reason ]  = policy;
+}
+
+void RedialScheduler::start()
+{
+    dummy_log_debug( MODULENAME, "start()" );
+
+    ticker_ = std::thread( & RedialScheduler::ticker_thread, this );
+}
+
+void RedialScheduler::shutdown()
+{
+    must_stop_  = true;
+
+    if( ticker_.joinable() )
+        ticker_.join();
+}
+
+bool RedialScheduler::schedule( const std::string & party, uint32_t attempt, const CallOutcome & outcome )
+{
+    MUTEX_SCOPE_LOCK( mutex_ );
+
+    auto policy = find_policy( outcome );
+
+    if( policy == nullptr )
+        return false;
+
+    if( attempt >= max_attempts_ )
+    {
+        dummy_log_debug( MODULENAME, "%s: no attempts left after %u", party.c_str(), attempt );
+
+        num_exhausted_.fetch_add( 1, std::memory_order_relaxed );
+
+        return false;
+    }
+
+    double delay_s = policy->delay_s * std::pow( policy->factor, attempt - 1 );
+
+    if( delay_s > policy->max_delay_s )
+        delay_s = policy->max_delay_s;
+
+    Entry e;
+
+    e.party     = parties_.add( party );
+    e.due       = get_ticks( std::chrono::steady_clock::now() ) + static_cast<uint32_t>( delay_s * 1000 / tick_ms_ );
+    e.attempt   = attempt;
+
+    heap_.push_back( e );
+    std::push_heap( heap_.begin(), heap_.end(), Greater() );
+
+    num_pending_    = heap_.size();
+    num_scheduled_.fetch_add( 1, std::memory_order_relaxed );
+
+    dummy_log_debug( MODULENAME, "%s: %s, redial in %.0f s", party.c_str(), StrHelper::to_string( outcome.result ).c_str(), delay_s );
+
+    return true;
+}
+
+uint32_t RedialScheduler::get_num_pending() const
+{
+    // read in the reverse order of release_due(), so a redial is always seen in one of them
+    uint32_t res = num_pending_.load();
+
+    return res + num_in_transit_.load();
+}
+
+uint32_t RedialScheduler::get_num_scheduled() const
+{
+    return num_scheduled_.load( std::memory_order_relaxed );
+}
+
+uint32_t RedialScheduler::get_num_released() const
+{
+    return num_released_.load( std::memory_order_relaxed );
+}
+
+uint32_t RedialScheduler::get_num_exhausted() const
+{
+    return num_exhausted_.load( std::memory_order_relaxed );
+}
+
+void RedialScheduler::ticker_thread()
+{
+    dummy_log_debug( MODULENAME, "ticker_thread: started" );
+
+    while( must_stop_ == false )
+    {
+        std::this_thread::sleep_for( std::chrono::milliseconds( tick_ms_ ) );
+
+        release_due();
+    }
+
+    dummy_log_debug( MODULENAME, "ticker_thread: exit" );
+}
+
+void RedialScheduler::release_due()
+{
+    std::vector<std::pair<std::string,uint32_t>> due;
+
+    {
+        MUTEX_SCOPE_LOCK( mutex_ );
+
+        auto now = get_ticks( std::chrono::steady_clock::now() );
+
+        while( heap_.empty() == false && heap_.front().due <= now )
+        {
+            auto & e = heap_.front();
+
+            due.push_back( std::make_pair( parties_.get( e.party ), e.attempt + 1 ) );
+
+            parties_.release( e.party );
+
+            std::pop_heap( heap_.begin(), heap_.end(), Greater() );
+            heap_.pop_back();
+        }
+
+        // counted as in transit before they leave the heap count
+        num_in_transit_ += due.size();
+        num_pending_    = heap_.size();
+    }
+
+    if( due.empty() )
+        return;
+
+    num_released_.fetch_add( due.size(), std::memory_order_relaxed );
+
+    dummy_log_debug( MODULENAME, "releasing %u redial(s)", (unsigned) due.size() );
+
+    // the campaign calls schedule() for outcomes, so it is not called under the lock
+    campaign_->add_redials( due );
+
+    // the campaign holds them now
+    num_in_transit_ -= due.size();
+}
+
+const RedialScheduler::Policy * RedialScheduler::find_policy( const CallOutcome & outcome ) const
+{
+    // private: no mutex lock
+
+    if( outcome.failure_reason != failure_reason_e::NONE )
+    {
+        auto it = reason_policies_.find( outcome.failure_reason );
+
+        if( it != reason_policies_.end() )
+            return & it->second;
+    }
+
+    auto it = result_policies_.find( outcome.result );
+
+    if( it != result_policies_.end() )
+        return & it->second;
+
+    return nullptr;
+}
+
+uint32_t RedialScheduler::get_ticks( const std::chrono::steady_clock::time_point & t ) const
+{
+    return static_cast<uint32_t>( std::chrono::duration_cast<std::chrono::milliseconds>( t - epoch_ ).count() / tick_ms_ );
+}
+
+NAMESPACE_DIALER_END
@@ -0,0 +1,135 @@
+/*
+
+Redial scheduler.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+// $Revision: 12038 $ $Date:: 2019-09-25 #$ $Author: serge $
+
+#ifndef LIB_DIALER_REDIAL_SCHEDULER_H
+#define LIB_DIALER_REDIAL_SCHEDULER_H
+
+#include <cstdint>                  // uint32_t
+#include <string>                   // std::string
+#include <vector>                   // std::vector
+#include <map>                      // std::map
+#include <mutex>                    // std::mutex
+#include <thread>                   // std::thread
+#include <atomic>                   // std::atomic
+#include <chrono>                   // std::chrono::steady_clock
+
+#include "call_outcome.h"           // CallOutcome
+#include "party_table.h"            // PartyTable
+
+#include "namespace_lib.h"          // NAMESPACE_DIALER_START
+
+NAMESPACE_DIALER_START
+
+class Campaign;
+
+// Keeps the parties to be dialed again and gives them back to the campaign when due.
+// The delay depends on the outcome: a policy set for the failure reason wins over
+// the one set for the call result, results without a policy are not redialed.
+// Pending redials are a binary min-heap of 16 byte entries, numbers are packed into
+// 64 bits, so millions of them fit in little memory.
+class RedialScheduler
+{
+public:
+    struct Policy
+    {
+        uint32_t    delay_s;        // before the 1st redial
+        uint32_t    max_delay_s;
+        double      factor;         // delay growth per attempt
+    };
+
+public:
+    RedialScheduler();
+    ~RedialScheduler();
+
+    // max_attempts - including the first call
+    bool init( Campaign * campaign, uint32_t max_attempts, uint32_t tick_ms = 100 );
+
+    // policies are set before start()
+    void set_policy( call_result_e result, const Policy & policy );
+    void set_policy( failure_reason_e reason, const Policy & policy );
+
+    void start();
+    void shutdown();
+
+    // attempt - number of calls made to the party so far,
+    // returns false if the party is not redialed; can be called from any thread
+    bool schedule( const std::string & party, uint32_t attempt, const CallOutcome & outcome );
+
+    // lock-free; pending includes the redials being handed over to the campaign
+    uint32_t get_num_pending() const;
+    uint32_t get_num_scheduled() const;
+    uint32_t get_num_released() const;
+    uint32_t get_num_exhausted() const;
+
+private:
+    struct Entry
+    {
+        uint64_t    party;          // key in parties_
+        uint32_t    due;            // ticks since start
+        uint32_t    attempt;
+    };
+
+    struct Greater
+    {
+        bool operator()( const Entry & a, const Entry & b ) const
+        {
+            return a.due > b.due;
+        }
+    };
+
+private:
+    void ticker_thread();
+    void release_due();
+
+    const Policy * find_policy( const CallOutcome & outcome ) const;
+
+    uint32_t get_ticks( const std::chrono::steady_clock::time_point & t ) const;
+
+private:
+    mutable std::mutex                      mutex_;
+
+    Campaign                                * campaign_;
+    uint32_t                                max_attempts_;
+    uint32_t                                tick_ms_;
+    std::chrono::steady_clock::time_point   epoch_;
+
+    std::map<call_result_e,Policy>          result_policies_;
+    std::map<failure_reason_e,Policy>       reason_policies_;
+
+    std::vector<Entry>                      heap_;
+
+    PartyTable                              parties_;
+
+    std::thread                             ticker_;
+    std::atomic<bool>                       must_stop_;
+
+    std::atomic<uint32_t>                   num_pending_;
+    std::atomic<uint32_t>                   num_in_transit_;    // released, not added to the campaign yet
+    std::atomic<uint32_t>                   num_scheduled_;
+    std::atomic<uint32_t>                   num_released_;
+    std::atomic<uint32_t>                   num_exhausted_;
+};
+
+NAMESPACE_DIALER_END
+
+#endif // LIB_DIALER_REDIAL_SCHEDULER_H
@@ -0,0 +1,146 @@
+/*
+
+Route limiter.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+// $Revision: 12038 $ $Date:: 2019-09-25 #$ $Author: serge $
+
+#include "route_limiter.h"          // self
+
+#include <algorithm>                // std::max, std::min
+#include <tuple>                    // std::forward_as_tuple
+
+#include "../utils/dummy_logger.h"  // dummy_log
+
+#define MODULENAME      "RouteLimiter"
+
+NAMESPACE_DIALER_START
+
+#define MAX_INTERVAL_NS     ( 1e17 )            // about 3 years, keeps tat far from overflow
+
+static int64_t to_ns( double ns )
+{
+    return static_cast<int64_t>( std::min( ns, MAX_INTERVAL_NS ) );
+}
+
+// very low rates and big bursts are capped instead of overflowing int64
+RouteLimiter::Bucket::Bucket( double max_rate, uint32_t burst, uint32_t max_calls ):
+    interval_ns( ( max_rate > 0 ) ? to_ns( 1e9 / max_rate ) : 0 ),
+    tolerance_ns( ( burst > 1 ) ? to_ns( static_cast<double>( interval_ns ) * ( burst - 1 ) ) : 0 ),
+    max_calls( max_calls ),
+    tat( 0 ),
+    num_calls( 0 )
+{
+}
+
+RouteLimiter::RouteLimiter( const DialPlan & plan ):
+    epoch_( std::chrono::steady_clock::now() )
+{
+    for( uint32_t i = 0; i < plan.get_num_routes(); ++i )
+    {
+        const auto & r = plan.get_route( i );
+
+        if( r.max_rate == 0 && r.max_calls == 0 )
+            continue;
+
+        buckets_.emplace( std::piecewise_construct,
+                std::forward_as_tuple( r.prefix ),
+                std::forward_as_tuple( r.max_rate, r.burst, r.max_calls ) );
+    }
+
+    dummy_log_info( MODULENAME, "created: %u limited route(s)", (unsigned) buckets_.size() );
+}
+
+RouteLimiter::result_e RouteLimiter::try_acquire( const std::string & prefix )
+{
+    auto it = buckets_.find( prefix );
+
+    if( it == buckets_.end() )
+        return result_e::OK;
+
+    auto & b = it->second;
+
+    // the slot is taken first and given back on failure, so concurrent callers never exceed max_calls
+    uint32_t num_calls = b.num_calls.fetch_add( 1, std::memory_order_acq_rel );
+
+    if( b.max_calls > 0 && num_calls >= b.max_calls )
+    {
+        b.num_calls.fetch_sub( 1, std::memory_order_acq_rel );
+
+        return result_e::BUSY;
+    }
+
+    if( take_token( b ) == false )
+    {
+        b.num_calls.fetch_sub( 1, std::memory_order_acq_rel );
+
+        return result_e::RATE_LIMITED;
+    }
+
+    return result_e::OK;
+}
+
+void RouteLimiter::release( const std::string & prefix )
+{
+    auto it = buckets_.find( prefix );
+
+    if( it == buckets_.end() )
+        return;
+
+    it->second.num_calls.fetch_sub( 1, std::memory_order_acq_rel );
+}
+
+uint32_t RouteLimiter::get_num_calls( const std::string & prefix ) const
+{
+    auto it = buckets_.find( prefix );
+
+    if( it == buckets_.end() )
+        return 0;
+
+    return it->second.num_calls.load( std::memory_order_relaxed );
+}
+
+bool RouteLimiter::take_token( Bucket & b )
+{
+    if( b.interval_ns == 0 )
+        return true;
+
+    int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - epoch_ ).count();
+
+    int64_t tat = b.tat.load( std::memory_order_relaxed );
+
+    // a bucket of burst tokens is full while tat <= now, each call moves tat by one interval
+    int64_t next;
+
+    do
+    {
+        int64_t t = std::max( tat, now );
+
+        if( t - now > b.tolerance_ns )
+            return false;
+
+        next = t + b.interval_ns;
+    }
+    while( b.tat.compare_exchange_weak( tat, next, std::memory_order_relaxed ) == false );
+
+    return true;
+}
+
+NAMESPACE_DIALER_END
@@ -0,0 +1,89 @@
+/*
+
+Route limiter.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+// $Revision: 12038 $ $Date:: 2019-09-25 #$ $Author: serge $
+
+#ifndef LIB_DIALER_ROUTE_LIMITER_H
+#define LIB_DIALER_ROUTE_LIMITER_H
+
+#include <cstdint>                  // uint32_t
+#include <string>                   // std::string
+#include <unordered_map>            // std::unordered_map
+#include <atomic>                   // std::atomic
+#include <chrono>                   // std::chrono::steady_clock
+
+#include "dial_plan.h"              // DialPlan
+
+#include "namespace_lib.h"          // NAMESPACE_DIALER_START
+
+NAMESPACE_DIALER_START
+
+// Enforces max_rate/burst and max_calls of the routes of a dial plan, keyed by route prefix.
+// The set of routes is fixed on construction and every limit is kept in atomics,
+// so one limiter can be shared by several MultiDialers without a lock.
+// The token bucket is stored as its theoretical arrival time (GCRA), i.e. in one word.
+class RouteLimiter
+{
+public:
+    enum class result_e
+    {
+        OK,
+        RATE_LIMITED,
+        BUSY
+    };
+
+public:
+    explicit RouteLimiter( const DialPlan & plan );
+
+    // a call slot and a token of the route, release() must follow OK
+    result_e try_acquire( const std::string & prefix );
+
+    // frees the call slot
+    void release( const std::string & prefix );
+
+    uint32_t get_num_calls( const std::string & prefix ) const;
+
+private:
+    struct Bucket
+    {
+        Bucket( double max_rate, uint32_t burst, uint32_t max_calls );
+
+        int64_t                 interval_ns;    // between two calls at max_rate, 0 - unlimited
+        int64_t                 tolerance_ns;   // how far the arrival time may run ahead of now
+        uint32_t                max_calls;      // 0 - unlimited
+
+        std::atomic<int64_t>    tat;            // theoretical arrival time of the next call
+        std::atomic<uint32_t>   num_calls;
+    };
+
+private:
+    bool take_token( Bucket & b );
+
+private:
+    std::chrono::steady_clock::time_point       epoch_;
+
+    std::unordered_map<std::string,Bucket>      buckets_;   // routes with limits only, read-only
+};
+
+NAMESPACE_DIALER_END
+
+#endif // LIB_DIALER_ROUTE_LIMITER_H
@@ -0,0 +1,108 @@
+/*
+
+Sequence lock.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+// $Revision: 12038 $ $Date:: 2019-09-25 #$ $Author: serge $
+
+#ifndef LIB_DIALER_SEQLOCK_H
+#define LIB_DIALER_SEQLOCK_H
+
+#include <cstdint>                  // uint64_t
+#include <cstring>                  // memcpy
+#include <atomic>                   // std::atomic
+
+#include "namespace_lib.h"          // NAMESPACE_DIALER_START
+
+NAMESPACE_DIALER_START
+
+// Single writer, any number of readers. Readers never block the writer,
+// they retry if the value was changed while being read.
+// The value is kept in atomic words, so _T must be trivially copyable.
+template <class _T>
+class SeqLockT
+{
+public:
+    SeqLockT():
+        seq_( 0 )
+    {
+        for( auto & w : data_ )
+            w.store( 0, std::memory_order_relaxed );
+    }
+
+    void store( const _T & value )
+    {
+        uint64_t buf[ WORDS ] = { 0 };
+
+        memcpy( buf, & value, sizeof( _T ) );
+
+        auto seq = seq_.load( std::memory_order_relaxed );
+
+        seq_.store( seq + 1, std::memory_order_relaxed );
+
+        std::atomic_thread_fence( std::memory_order_release );
+
+        for( uint32_t i = 0; i < WORDS; ++i )
+            data_[ i ].store( buf[ i ], std::memory_order_relaxed );
+
+        seq_.store( seq + 2, std::memory_order_release );
+    }
+
+    _T load() const
+    {
+        uint64_t buf[ WORDS ];
+
+        while( true )
+        {
+            auto seq_1 = seq_.load( std::memory_order_acquire );
+
+            if( seq_1 & 1 )
+                continue;   // write in progress
+
+            for( uint32_t i = 0; i < WORDS; ++i )
+                buf[ i ] = data_[ i ].load( std::memory_order_relaxed );
+
+            std::atomic_thread_fence( std::memory_order_acquire );
+
+            auto seq_2 = seq_.load( std::memory_order_relaxed );
+
+            if( seq_1 == seq_2 )
+                break;
+        }
+
+        _T res;
+
+        memcpy( & res, buf, sizeof( _T ) );
+
+        return res;
+    }
+
+private:
+    enum
+    {
+        WORDS   = ( sizeof( _T ) + sizeof( uint64_t ) - 1 ) / sizeof( uint64_t )
+    };
+
+    std::atomic<uint32_t>   seq_;
+    std::atomic<uint64_t>   data_[ WORDS ];
+};
+
+NAMESPACE_DIALER_END
+
+#endif // LIB_DIALER_SEQLOCK_H
@@ -1,8 +1,8 @@
 /*
 
-Wrapper for boost::regex_match()
+Dialer statistics.
 
-Copyright (C) 2016 Sergey Kolevatov
+Copyright (C) 2019 Sergey Kolevatov
 
 This program is free software: you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -19,18 +19,26 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 
 */
 
-// $Revision: 4429 $ $Date:: 2016-09-19 #$ $Author: serge $
+// $Revision: 12038 $ $Date:: 2019-09-25 #$ $Author: serge $
 
-#include "regex_match.h"                // self
-
-#include <boost/regex.hpp>              // boost::regex_match()
+#include "stats.h"                  // self
 
 NAMESPACE_DIALER_START
 
-bool regex_match( const std::string & s, const std::string & regex )
+Stats::Stats()
+{
+    for( auto & c : counters_ )
+        c.store( 0, std::memory_order_relaxed );
+}
+
+void Stats::inc( counter_e c, uint32_t n )
+{
+    counters_[ static_cast<int>( c ) ].fetch_add( n, std::memory_order_relaxed );
+}
+
+uint32_t Stats::get( counter_e c ) const
 {
-    boost::regex e( regex );
-    return boost::regex_match( s, e );
+    return counters_[ static_cast<int>( c ) ].load( std::memory_order_relaxed );
 }
 
 NAMESPACE_DIALER_END
@@ -0,0 +1,73 @@
+/*
+
+Dialer statistics.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+// $Revision: 12038 $ $Date:: 2019-09-25 #$ $Author: serge $
+
+#ifndef LIB_DIALER_STATS_H
+#define LIB_DIALER_STATS_H
+
+#include <cstdint>                  // uint32_t
+#include <atomic>                   // std::atomic
+
+#include "namespace_lib.h"          // NAMESPACE_DIALER_START
+
+NAMESPACE_DIALER_START
+
+enum class counter_e
+{
+    EXPIRED_REQUESTS    = 0,
+    QUEUED_REQUESTS,
+    CALL_SETUP_TIMEOUTS,
+    NO_ANSWER_TIMEOUTS,
+    DROP_TIMEOUTS_IN_WC,
+    DROP_TIMEOUTS_IN_C,
+    NO_ACCOUNT_AVAILABLE,
+    CALLS_LOST_ON_DISCONNECT,
+    DNC_BLOCKED,
+    NO_ROUTE,
+    ROUTE_BUSY,
+    ROUTE_RATE_LIMITED,
+    ROUTE_THROTTLED,
+    AIMD_DECREASES,
+    VOICEMAIL_DETECTED,
+    VOICEMAIL_DROPS,
+    VOICEMAIL_RECLAIMED_SEC,    // line-seconds the voicemail would have taken
+
+    COUNT
+};
+
+// counters are written by the worker thread and can be read from any thread
+class Stats
+{
+public:
+    Stats();
+
+    void inc( counter_e c, uint32_t n = 1 );
+
+    uint32_t get( counter_e c ) const;
+
+private:
+    std::atomic<uint32_t>   counters_[ static_cast<int>( counter_e::COUNT ) ];
+};
+
+NAMESPACE_DIALER_END
+
+#endif // LIB_DIALER_STATS_H
@@ -78,6 +78,101 @@ const std::string & StrHelper::to_string( const PlayerSM::state_e & l )
     return it->second;
 }
 
+const std::string & StrHelper::to_string( const counter_e & l )
+{
+    typedef std::map< counter_e, std::string > Map;
+    static Map m =
+    {
+        { counter_e:: TUPLE_VAL_STR( EXPIRED_REQUESTS ) },
+        { counter_e:: TUPLE_VAL_STR( QUEUED_REQUESTS ) },
+        { counter_e:: TUPLE_VAL_STR( CALL_SETUP_TIMEOUTS ) },
+        { counter_e:: TUPLE_VAL_STR( NO_ANSWER_TIMEOUTS ) },
+        { counter_e:: TUPLE_VAL_STR( DROP_TIMEOUTS_IN_WC ) },
+        { counter_e:: TUPLE_VAL_STR( DROP_TIMEOUTS_IN_C ) },
+        { counter_e:: TUPLE_VAL_STR( NO_ACCOUNT_AVAILABLE ) },
+        { counter_e:: TUPLE_VAL_STR( CALLS_LOST_ON_DISCONNECT ) },
+        { counter_e:: TUPLE_VAL_STR( DNC_BLOCKED ) },
+        { counter_e:: TUPLE_VAL_STR( NO_ROUTE ) },
+        { counter_e:: TUPLE_VAL_STR( ROUTE_BUSY ) },
+        { counter_e:: TUPLE_VAL_STR( ROUTE_RATE_LIMITED ) },
+        { counter_e:: TUPLE_VAL_STR( ROUTE_THROTTLED ) },
+        { counter_e:: TUPLE_VAL_STR( AIMD_DECREASES ) },
+        { counter_e:: TUPLE_VAL_STR( VOICEMAIL_DETECTED ) },
+        { counter_e:: TUPLE_VAL_STR( VOICEMAIL_DROPS ) },
+        { counter_e:: TUPLE_VAL_STR( VOICEMAIL_RECLAIMED_SEC ) },
+    };
+
+    auto it = m.find( l );
+
+    static const std::string undef( "???" );
+
+    if( it == m.end() )
+        return undef;
+
+    return it->second;
+}
+
+const std::string & StrHelper::to_string( const failure_reason_e & l )
+{
+    typedef std::map< failure_reason_e, std::string > Map;
+    static Map m =
+    {
+        { failure_reason_e:: TUPLE_VAL_STR( NONE ) },
+        { failure_reason_e:: TUPLE_VAL_STR( MISC_ERROR ) },
+        { failure_reason_e:: TUPLE_VAL_STR( USER_DOES_NOT_EXIST ) },
+        { failure_reason_e:: TUPLE_VAL_STR( USER_OFFLINE ) },
+        { failure_reason_e:: TUPLE_VAL_STR( NO_PROXY_FOUND ) },
+        { failure_reason_e:: TUPLE_VAL_STR( SESSION_TERMINATED ) },
+        { failure_reason_e:: TUPLE_VAL_STR( NO_COMMON_CODEC ) },
+        { failure_reason_e:: TUPLE_VAL_STR( SOUND_IO_ERROR ) },
+        { failure_reason_e:: TUPLE_VAL_STR( REMOTE_SOUND_DEVICE_ERROR ) },
+        { failure_reason_e:: TUPLE_VAL_STR( BLOCKED_BY_RECIPIENT ) },
+        { failure_reason_e:: TUPLE_VAL_STR( RECIPIENT_NOT_FRIEND ) },
+        { failure_reason_e:: TUPLE_VAL_STR( NOT_AUTHORIZED_BY_RECIPIENT ) },
+        { failure_reason_e:: TUPLE_VAL_STR( SOUND_RECORDING_ERROR ) },
+        { failure_reason_e:: TUPLE_VAL_STR( COMMERCIAL_CONTACT ) },
+        { failure_reason_e:: TUPLE_VAL_STR( DROPPED_BY_HOST ) },
+        { failure_reason_e:: TUPLE_VAL_STR( UNKNOWN ) },
+    };
+
+    auto it = m.find( l );
+
+    static const std::string undef( "???" );
+
+    if( it == m.end() )
+        return undef;
+
+    return it->second;
+}
+
+const std::string & StrHelper::to_string( const call_result_e & l )
+{
+    typedef std::map< call_result_e, std::string > Map;
+    static Map m =
+    {
+        { call_result_e:: TUPLE_VAL_STR( REJECTED ) },
+        { call_result_e:: TUPLE_VAL_STR( SETUP_ERROR ) },
+        { call_result_e:: TUPLE_VAL_STR( FAILED ) },
+        { call_result_e:: TUPLE_VAL_STR( BUSY ) },
+        { call_result_e:: TUPLE_VAL_STR( REFUSED ) },
+        { call_result_e:: TUPLE_VAL_STR( NO_ANSWER ) },
+        { call_result_e:: TUPLE_VAL_STR( CANCELED ) },
+        { call_result_e:: TUPLE_VAL_STR( COMPLETED ) },
+        { call_result_e:: TUPLE_VAL_STR( CONNECTION_LOST ) },
+        { call_result_e:: TUPLE_VAL_STR( BLOCKED ) },
+        { call_result_e:: TUPLE_VAL_STR( VOICEMAIL ) },
+    };
+
+    auto it = m.find( l );
+
+    static const std::string undef( "???" );
+
+    if( it == m.end() )
+        return undef;
+
+    return it->second;
+}
+
 
 NAMESPACE_DIALER_END
 
@@ -24,6 +24,9 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 #include "namespace_lib.h"      // NAMESPACE_DIALER_START
 #include "dialer.h"             // enums
 #include "player_sm.h"          // enums
+#include "stats.h"              // counter_e
+#include "failure_reason.h"     // failure_reason_e
+#include "call_outcome.h"       // call_result_e
 
 NAMESPACE_DIALER_START
 
@@ -32,6 +35,9 @@ class StrHelper
 public:
     static const std::string & to_string( const Dialer::state_e & l );
     static const std::string & to_string( const PlayerSM::state_e & l );
+    static const std::string & to_string( const counter_e & l );
+    static const std::string & to_string( const failure_reason_e & l );
+    static const std::string & to_string( const call_result_e & l );
 };
 
 NAMESPACE_DIALER_END
@@ -0,0 +1,245 @@
+/*
+
+Hierarchical timer wheel.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+// $Revision: 12038 $ $Date:: 2019-09-25 #$ $Author: serge $
+
+#include "timer_wheel.h"            // self
+
+#include "../utils/utils_assert.h"  // ASSERT
+
+NAMESPACE_DIALER_START
+
+TimerWheel::TimerWheel():
+    tick_ms_( 10 ),
+    tick_( 0 ),
+    free_( NIL ),
+    size_( 0 )
+{
+    for( auto & s : slots_ )
+        s = NIL;
+}
+
+void TimerWheel::init( uint32_t tick_ms, const Clock::time_point & now )
+{
+    ASSERT( tick_ms > 0 );
+    ASSERT( size_ == 0 );
+
+    tick_ms_    = tick_ms;
+    start_      = now;
+    tick_       = 0;
+}
+
+TimerWheel::timer_id_t TimerWheel::insert( uint32_t timeout_ms, const Callback & callback )
+{
+    uint32_t n;
+
+    if( free_ != NIL )
+    {
+        n       = free_;
+        free_   = nodes_[ n ].next;
+    }
+    else
+    {
+        n       = static_cast<uint32_t>( nodes_.size() );
+
+        Node node;
+
+        node.slot       = NIL;
+        node.generation = 1;
+
+        nodes_.push_back( node );
+    }
+
+    // the wheel may lag behind the clock if advance() was not called for a while
+    uint64_t now_tick = std::chrono::duration_cast<std::chrono::milliseconds>( Clock::now() - start_ ).count() / tick_ms_ + 1;
+
+    if( now_tick < tick_ )
+        now_tick = tick_;
+
+    uint64_t ticks = timeout_ms / tick_ms_;
+
+    if( ticks > MAX_TICKS )
+        ticks = MAX_TICKS;
+
+    Node & node = nodes_[ n ];
+
+    node.expire     = now_tick + ticks;
+    node.callback   = callback;
+
+    place( n );
+
+    ++size_;
+
+    return ( static_cast<uint64_t>( node.generation ) << 32 ) | n;
+}
+
+bool TimerWheel::cancel( timer_id_t id )
+{
+    uint32_t n          = static_cast<uint32_t>( id & 0xFFFFFFFF );
+    uint32_t generation = static_cast<uint32_t>( id >> 32 );
+
+    if( n >= nodes_.size() )
+        return false;
+
+    Node & node = nodes_[ n ];
+
+    if( node.slot == NIL || node.generation != generation )
+        return false;
+
+    unlink( n );
+    release( n );
+
+    return true;
+}
+
+void TimerWheel::advance( const Clock::time_point & now )
+{
+    uint64_t now_tick = std::chrono::duration_cast<std::chrono::milliseconds>( now - start_ ).count() / tick_ms_;
+
+    while( tick_ <= now_tick )
+    {
+        process_tick();
+    }
+}
+
+uint32_t TimerWheel::get_tick_ms() const
+{
+    return tick_ms_;
+}
+
+uint32_t TimerWheel::get_size() const
+{
+    return size_;
+}
+
+void TimerWheel::place( uint32_t n )
+{
+    Node & node = nodes_[ n ];
+
+    if( node.expire < tick_ )
+        node.expire = tick_;
+
+    uint64_t delta = node.expire - tick_;
+
+    uint32_t level = 0;
+
+    while( level < LEVELS - 1 && delta >= ( 1ULL << ( LEVEL_BITS * ( level + 1 ) ) ) )
+        ++level;
+
+    uint32_t index = ( node.expire >> ( LEVEL_BITS * level ) ) & SLOT_MASK;
+
+    link( n, level * SLOTS + index );
+}
+
+void TimerWheel::link( uint32_t n, uint32_t slot )
+{
+    Node & node = nodes_[ n ];
+
+    node.slot   = slot;
+    node.prev   = NIL;
+    node.next   = slots_[ slot ];
+
+    if( node.next != NIL )
+        nodes_[ node.next ].prev = n;
+
+    slots_[ slot ] = n;
+}
+
+void TimerWheel::unlink( uint32_t n )
+{
+    Node & node = nodes_[ n ];
+
+    if( node.prev != NIL )
+        nodes_[ node.prev ].next = node.next;
+    else
+        slots_[ node.slot ] = node.next;
+
+    if( node.next != NIL )
+        nodes_[ node.next ].prev = node.prev;
+}
+
+void TimerWheel::release( uint32_t n )
+{
+    Node & node = nodes_[ n ];
+
+    node.callback   = nullptr;
+    node.slot       = NIL;
+    node.prev       = NIL;
+    node.next       = free_;
+
+    if( ++node.generation == 0 )
+        node.generation = 1;
+
+    free_   = n;
+
+    --size_;
+}
+
+uint32_t TimerWheel::cascade( uint32_t level, uint32_t index )
+{
+    uint32_t slot   = level * SLOTS + index;
+    uint32_t n      = slots_[ slot ];
+
+    slots_[ slot ]  = NIL;
+
+    while( n != NIL )
+    {
+        uint32_t next = nodes_[ n ].next;
+
+        place( n );
+
+        n = next;
+    }
+
+    return index;
+}
+
+void TimerWheel::process_tick()
+{
+    uint32_t index = tick_ & SLOT_MASK;
+
+    if( index == 0 &&
+            cascade( 1, ( tick_ >> LEVEL_BITS ) & SLOT_MASK ) == 0 &&
+            cascade( 2, ( tick_ >> ( 2 * LEVEL_BITS ) ) & SLOT_MASK ) == 0 )
+    {
+        cascade( 3, ( tick_ >> ( 3 * LEVEL_BITS ) ) & SLOT_MASK );
+    }
+
+    ++tick_;
+
+    while( slots_[ index ] != NIL )
+    {
+        uint32_t n = slots_[ index ];
+
+        unlink( n );
+
+        Callback callback;
+
+        callback.swap( nodes_[ n ].callback );
+
+        release( n );
+
+        // callback may insert or cancel timers
+        callback();
+    }
+}
+
+NAMESPACE_DIALER_END
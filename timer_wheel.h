@@ -0,0 +1,102 @@
+/*
+
+Hierarchical timer wheel.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+// $Revision: 12038 $ $Date:: 2019-09-25 #$ $Author: serge $
+
+#ifndef LIB_DIALER_TIMER_WHEEL_H
+#define LIB_DIALER_TIMER_WHEEL_H
+
+#include <cstdint>                  // uint32_t
+#include <vector>                   // std::vector
+#include <functional>               // std::function
+#include <chrono>                   // std::chrono::steady_clock
+
+#include "namespace_lib.h"          // NAMESPACE_DIALER_START
+
+NAMESPACE_DIALER_START
+
+// Not thread-safe: owned and driven by a single thread.
+// Insert and cancel are O(1), nodes are recycled, so no allocation happens
+// in steady state as long as callbacks fit into std::function's local buffer.
+class TimerWheel
+{
+public:
+    typedef uint64_t                    timer_id_t;     // 0 - invalid id
+    typedef std::function<void()>       Callback;
+    typedef std::chrono::steady_clock   Clock;
+
+public:
+    TimerWheel();
+
+    void init( uint32_t tick_ms, const Clock::time_point & now );
+
+    timer_id_t insert( uint32_t timeout_ms, const Callback & callback );
+    bool cancel( timer_id_t id );
+
+    // fires all timers expired up to now
+    void advance( const Clock::time_point & now );
+
+    uint32_t get_tick_ms() const;
+    uint32_t get_size() const;
+
+private:
+    enum
+    {
+        LEVEL_BITS  = 6,
+        SLOTS       = 1 << LEVEL_BITS,
+        SLOT_MASK   = SLOTS - 1,
+        LEVELS      = 4,
+        MAX_TICKS   = ( 1 << ( LEVEL_BITS * LEVELS ) ) - 1,
+        NIL         = 0xFFFFFFFF
+    };
+
+    struct Node
+    {
+        uint32_t    prev;
+        uint32_t    next;
+        uint32_t    slot;           // level * SLOTS + index, NIL if node is free
+        uint32_t    generation;
+        uint64_t    expire;         // in ticks
+        Callback    callback;
+    };
+
+private:
+    void place( uint32_t n );
+    void link( uint32_t n, uint32_t slot );
+    void unlink( uint32_t n );
+    void release( uint32_t n );
+    uint32_t cascade( uint32_t level, uint32_t index );
+    void process_tick();
+
+private:
+    uint32_t                    tick_ms_;
+    Clock::time_point           start_;
+    uint64_t                    tick_;      // next tick to process
+
+    uint32_t                    slots_[ LEVELS * SLOTS ];
+    std::vector<Node>           nodes_;
+    uint32_t                    free_;      // head of the free node list
+    uint32_t                    size_;
+};
+
+NAMESPACE_DIALER_END
+
+#endif // LIB_DIALER_TIMER_WHEEL_H
@@ -0,0 +1,94 @@
+/*
+
+Typed callback adapter.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+// $Revision: 12038 $ $Date:: 2019-09-25 #$ $Author: serge $
+
+#include "typed_callback_adapter.h" // self
+
+#include <typeinfo>                 // typeid
+
+#include "../utils/dummy_logger.h"  // dummy_log
+#include "../utils/utils_assert.h"  // ASSERT
+
+#include "callback_dispatcher.h"    // CallbackDispatcher::deliver
+
+#define MODULENAME      "TypedCallbackAdapter"
+
+NAMESPACE_DIALER_START
+
+TypedCallbackAdapter::TypedCallbackAdapter():
+    callback_( nullptr ),
+    pool_( nullptr )
+{
+}
+
+bool TypedCallbackAdapter::init( ITypedCallback * callback, CallbackObjectPool * pool )
+{
+    if( callback == nullptr || pool == nullptr )
+        return false;
+
+    callback_   = callback;
+    pool_       = pool;
+
+    return true;
+}
+
+template<class _T>
+bool TypedCallbackAdapter::consume_t( const simple_voip::CallbackObject * obj )
+{
+    if( typeid( *obj ) != typeid( _T ) )
+        return false;
+
+    auto o = static_cast<const _T*>( obj );
+
+    CallbackDispatcher::deliver( callback_, * o );
+
+    pool_->release_t( o );
+
+    return true;
+}
+
+void TypedCallbackAdapter::consume( const simple_voip::CallbackObject * obj )
+{
+    if( consume_t<simple_voip::InitiateCallResponse>( obj )
+        || consume_t<simple_voip::ErrorResponse>( obj )
+        || consume_t<simple_voip::RejectResponse>( obj )
+        || consume_t<simple_voip::DropResponse>( obj )
+        || consume_t<simple_voip::PlayFileResponse>( obj )
+        || consume_t<simple_voip::PlayFileStopResponse>( obj )
+        || consume_t<simple_voip::RecordFileResponse>( obj )
+        || consume_t<simple_voip::Dialing>( obj )
+        || consume_t<simple_voip::Ringing>( obj )
+        || consume_t<simple_voip::Connected>( obj )
+        || consume_t<simple_voip::Failed>( obj )
+        || consume_t<simple_voip::ConnectionLost>( obj )
+        || consume_t<simple_voip::DtmfTone>( obj )
+        || consume_t<simple_voip::CallDuration>( obj ) )
+    {
+        return;
+    }
+
+    dummy_log_fatal( MODULENAME, "consume: unexpected object - %s", typeid( *obj ).name() );
+
+    ASSERT( 0 );
+}
+
+NAMESPACE_DIALER_END
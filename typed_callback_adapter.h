@@ -0,0 +1,59 @@
+/*
+
+Typed callback adapter.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+// $Revision: 12038 $ $Date:: 2019-09-25 #$ $Author: serge $
+
+#ifndef LIB_DIALER_TYPED_CALLBACK_ADAPTER_H
+#define LIB_DIALER_TYPED_CALLBACK_ADAPTER_H
+
+#include "../simple_voip/i_simple_voip_callback.h" // ISimpleVoipCallback
+
+#include "i_typed_callback.h"       // ITypedCallback
+#include "callback_object_pool.h"   // CallbackObjectPool
+
+#include "namespace_lib.h"          // NAMESPACE_DIALER_START
+
+NAMESPACE_DIALER_START
+
+// Presents ITypedCallback as ISimpleVoipCallback, for the paths where the
+// static type is lost, i.e. asynchronous delivery. Objects are released after the call.
+class TypedCallbackAdapter: virtual public simple_voip::ISimpleVoipCallback
+{
+public:
+    TypedCallbackAdapter();
+
+    bool init( ITypedCallback * callback, CallbackObjectPool * pool );
+
+    // interface ISimpleVoipCallback
+    virtual void consume( const simple_voip::CallbackObject * obj );
+
+private:
+    template<class _T>
+    bool consume_t( const simple_voip::CallbackObject * obj );
+
+private:
+    ITypedCallback          * callback_;
+    CallbackObjectPool      * pool_;
+};
+
+NAMESPACE_DIALER_END
+
+#endif // LIB_DIALER_TYPED_CALLBACK_ADAPTER_H